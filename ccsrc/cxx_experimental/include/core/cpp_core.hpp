@@ -18,6 +18,7 @@
 #include <complex>
 #include <fstream>
 #include <map>
+#include <optional>
 #include <string_view>
 #include <vector>
 
@@ -26,6 +27,9 @@
 #include "cengines/cpp_engine_list.hpp"
 #include "core/circuit_manager.hpp"
 #include "ops/cpp_command.hpp"
+#include "ops/gates/qubit_operator.hpp"
+#include "ops/parametric/config.hpp"
+#include "simulator/fusion_planner.hpp"
 #include "simulator/simulator.hpp"
 
 namespace td = tweedledum;
@@ -61,6 +65,36 @@ class CppCore {
     // WARN: this function does not take ownership of sim!
     void set_simulator_backend(::projectq::Simulator& sim);
 
+    /*!
+     * \brief Enable/disable deferred execution of gates during flush()
+     *
+     * In deferred mode, all the gates of a flush are streamed into the simulator which fuses them and only applies
+     * them to the state vector when required (ie. measurements, qubit operators, time evolutions or at the end of
+     * the flush). Otherwise every gate is applied to the state vector individually.
+     */
+    void set_deferred_execution(bool deferred);
+
+    //! Check whether deferred execution is enabled
+    bool deferred_execution() const {
+        return deferred_execution_;
+    }
+
+    /*!
+     * \brief Enable/disable the circuit-level fusion planner
+     *
+     * When enabled, all the gates between two synchronisation points of a flush (measurements, qubit operators, time
+     * evolutions) are split into fused blocks of at most \c max_qubits qubits by a fusion::FusionPlanner instead of
+     * relying on the greedy online fusion of the simulator.
+     *
+     * \param max_qubits Maximum number of qubits per fused block (0 to disable the planner)
+     */
+    void set_fusion_planner(unsigned max_qubits);
+
+    //! Return the number of simulator kernel launches during the last call to flush()
+    std::size_t get_kernel_launches() const {
+        return kernel_launches_;
+    }
+
     /*!
      * \brief Allocate a single qubit
      */
@@ -87,6 +121,26 @@ class CppCore {
      */
     std::map<unsigned, bool> get_measure_info();
 
+    /*!
+     * \brief Execute stored gates and compute the gradient of the expectation value of a Hamiltonian
+     *
+     * The parametric gates are evaluated numerically using \c subs before being applied. The derivatives with
+     * respect to all the symbols in \c params are then obtained with the adjoint method, ie. with a single backward
+     * sweep over the circuit regardless of the number of parameters (chain rule applied to the expression of the
+     * angle of each gate).
+     *
+     * \param hamiltonian Hermitian qubit operator
+     * \param qubit_ids IDs of the qubits the terms of the Hamiltonian act on
+     * \param params Symbols to differentiate with respect to
+     * \param subs Numerical values of all the symbols of the circuit
+     * \return The expectation value and its derivatives (in the order of \c params)
+     * \throw std::runtime_error if the circuit contains non-unitary operations
+     */
+    adjoint::Result get_expectation_with_gradient(const ops::QubitOperator& hamiltonian,
+                                                  const std::vector<qubit_id_t>& qubit_ids,
+                                                  const ops::parametric::param_list_t& params,
+                                                  const ops::parametric::subs_map_t& subs);
+
     //! Set output file name (stdout for printing to standard output)
     void set_output_stream(std::string_view file_name);
 
@@ -109,8 +163,14 @@ class CppCore {
     //! Insert an operation into circuit
     void apply_operation_(const gate_t& gate, const qureg_t& control_qubit_ids, const qureg_t& qubit_ids);
 
+    //! Remove the qubits deallocated since the last synchronisation from the simulator and the circuit
+    void apply_deallocations_();
+
     bool simulator_backend_;
     bool has_new_operations_;
+    bool deferred_execution_;
+    std::size_t kernel_launches_;
+    std::optional<fusion::FusionPlanner> fusion_planner_;
 
     ::projectq::Simulator* sim_;
 
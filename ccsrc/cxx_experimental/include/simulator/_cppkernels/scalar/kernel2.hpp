@@ -24,10 +24,12 @@ namespace details
         template <class V, class M, typename UINT, typename D>
         static inline void core(V &psi, UINT I, const D d, M const &m)
         {
+            using value_t = std::remove_reference_t<decltype(psi[I])>;
+
             const UINT d0 = d[0];
             const UINT d1 = d[1];
 
-            std::complex<double> v[4];
+            value_t v[4];
             v[0] = psi[I];
             v[1] = psi[I + d0];
             v[2] = psi[I + d1];
@@ -24,17 +24,19 @@ namespace details
         template <class V, class M, typename UINT, typename D>
         static inline void core(V &psi, UINT I, const D d, M const &m)
         {
+            using value_t = std::remove_reference_t<decltype(psi[I])>;
+
             const UINT d0 = d[0];
             const UINT d1 = d[1];
             const UINT d2 = d[2];
 
-            std::complex<double> v[4];
+            value_t v[4];
             v[0] = psi[I];
             v[1] = psi[I + d0];
             v[2] = psi[I + d1];
             v[3] = psi[I + d0 + d1];
 
-            std::complex<double> tmp[8];
+            value_t tmp[8];
 
             tmp[0] = add(mul(v[0], m[0][0]), add(mul(v[1], m[0][1]), add(mul(v[2], m[0][2]), mul(v[3], m[0][3]))));
             tmp[1] = add(mul(v[0], m[1][0]), add(mul(v[1], m[1][1]), add(mul(v[2], m[1][2]), mul(v[3], m[1][3]))));
@@ -16,6 +16,7 @@
 #ifndef VECTOR_KERNEL1_HPP
 #define VECTOR_KERNEL1_HPP
 
+#include "single_precision.hpp"
 #include "utils.hpp"
 
 namespace details
@@ -49,7 +50,12 @@ namespace details
         template <class V, class M, typename UINT, int CTRLMASK>
         static inline void dispatch(V &psi, M const &m, UINT ctrlmask, const unsigned *id)
         {
-            kernel_dispatch<1, kernel1, CTRLMASK>(psi, m, ctrlmask, id);
+            if constexpr (single::is_single_precision_v<V>) {
+                kernel_dispatch<1, single::kernel<1>, CTRLMASK>(psi, m, ctrlmask, id);
+            }
+            else {
+                kernel_dispatch<1, kernel1, CTRLMASK>(psi, m, ctrlmask, id);
+            }
         }
     };
 
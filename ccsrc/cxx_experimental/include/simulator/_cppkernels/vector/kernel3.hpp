@@ -16,6 +16,7 @@
 #ifndef VECTOR_KERNEL3_HPP
 #define VECTOR_KERNEL3_HPP
 
+#include "single_precision.hpp"
 #include "utils.hpp"
 
 namespace details
@@ -103,7 +104,12 @@ namespace details
         template <class V, class M, typename UINT, int CTRLMASK>
         static inline void dispatch(V &psi, M const &m, UINT ctrlmask, const unsigned *id)
         {
-            kernel_dispatch<3, kernel3, CTRLMASK>(psi, m, ctrlmask, id);
+            if constexpr (single::is_single_precision_v<V>) {
+                kernel_dispatch<3, single::kernel<3>, CTRLMASK>(psi, m, ctrlmask, id);
+            }
+            else {
+                kernel_dispatch<3, kernel3, CTRLMASK>(psi, m, ctrlmask, id);
+            }
         }
     };
 }  // namespace details
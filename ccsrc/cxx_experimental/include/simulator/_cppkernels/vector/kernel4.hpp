@@ -16,6 +16,7 @@
 #ifndef VECTOR_KERNEL4_HPP
 #define VECTOR_KERNEL4_HPP
 
+#include "single_precision.hpp"
 #include "utils.hpp"
 
 namespace details
@@ -240,7 +241,12 @@ namespace details
         template <class V, class M, typename UINT, int CTRLMASK>
         static inline void dispatch(V &psi, M const &m, UINT ctrlmask, const unsigned *id)
         {
-            kernel_dispatch<4, kernel4, CTRLMASK>(psi, m, ctrlmask, id);
+            if constexpr (single::is_single_precision_v<V>) {
+                kernel_dispatch<4, single::kernel<4>, CTRLMASK>(psi, m, ctrlmask, id);
+            }
+            else {
+                kernel_dispatch<4, kernel4, CTRLMASK>(psi, m, ctrlmask, id);
+            }
         }
     };
 }  // namespace details
@@ -16,6 +16,7 @@
 #ifndef VECTOR_KERNEL5_HPP
 #define VECTOR_KERNEL5_HPP
 
+#include "single_precision.hpp"
 #include "utils.hpp"
 
 namespace details
@@ -751,7 +752,12 @@ namespace details
         template <class V, class M, typename UINT, int CTRLMASK>
         static inline void dispatch(V &psi, M const &m, UINT ctrlmask, const unsigned *id)
         {
-            kernel_dispatch<5, kernel5, CTRLMASK>(psi, m, ctrlmask, id);
+            if constexpr (single::is_single_precision_v<V>) {
+                kernel_dispatch<5, single::kernel<5>, CTRLMASK>(psi, m, ctrlmask, id);
+            }
+            else {
+                kernel_dispatch<5, kernel5, CTRLMASK>(psi, m, ctrlmask, id);
+            }
         }
     };
 }  // namespace details
@@ -0,0 +1,154 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef VECTOR_SINGLE_PRECISION_HPP
+#define VECTOR_SINGLE_PRECISION_HPP
+
+#include "utils.hpp"
+
+#include <complex>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#    include <immintrin.h>
+#endif  // __AVX2__
+
+namespace details
+{
+    namespace single
+    {
+        template <class V>
+        inline constexpr bool is_single_precision_v = std::is_same_v<typename V::value_type, std::complex<float>>;
+
+        template <unsigned N>
+        class kernel;
+
+#if defined(__AVX2__)
+        inline __m256 fmadd(__m256 a, __m256 b, __m256 c)
+        {
+#    ifdef __FMA__
+            return _mm256_fmadd_ps(a, b, c);
+#    else
+            return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#    endif  // __FMA__
+        }
+
+        // c - a * b
+        inline __m256 fnmadd(__m256 a, __m256 b, __m256 c)
+        {
+#    ifdef __FMA__
+            return _mm256_fnmadd_ps(a, b, c);
+#    else
+            return _mm256_sub_ps(c, _mm256_mul_ps(a, b));
+#    endif  // __FMA__
+        }
+
+        inline __m256 set4(std::complex<double> c0, std::complex<double> c1, std::complex<double> c2,
+                           std::complex<double> c3)
+        {
+            return _mm256_setr_ps(static_cast<float>(c0.real()), static_cast<float>(c0.imag()),
+                                  static_cast<float>(c1.real()), static_cast<float>(c1.imag()),
+                                  static_cast<float>(c2.real()), static_cast<float>(c2.imag()),
+                                  static_cast<float>(c3.real()), static_cast<float>(c3.imag()));
+        }
+
+        // Dense kernel acting on a single-precision state vector
+        //
+        // A 256-bit register holds four single-precision complex numbers, i.e. four rows of a column of the matrix
+        // (N >= 2), or both columns of a single-qubit gate (N == 1). The input amplitudes are broadcast as
+        // (re, re, ...) and (im, im, ...):
+        //     out[r] += re(v[j]) * m[r][j] - im(v[j]) * mt[r][j]
+        // with mt = (im(m), -re(m)) as computed by utils::make_hermitian_array().
+        //
+        // The gate matrix is provided in double precision and only converted once per kernel call.
+        template <unsigned N>
+        class kernel
+        {
+        public:
+            static constexpr auto dim = 1U << N;
+            static constexpr auto rows = dim < 4U ? 1U : dim / 4U;
+            static constexpr auto num_regs = N == 1 ? 1U : dim * rows;
+
+            template <class V, class M, typename UINT, typename D>
+            static inline void core(V &psi, UINT I, const D d, M const &m_tuple)
+            {
+                const auto &[m, mt] = m_tuple;
+
+                if constexpr (N == 1) {
+                    const auto *v0 = reinterpret_cast<const float *>(&psi[I]);
+                    const auto *v1 = reinterpret_cast<const float *>(&psi[I + d[0]]);
+                    const auto re = _mm256_set_m128(_mm_set1_ps(v1[0]), _mm_set1_ps(v0[0]));
+                    const auto im = _mm256_set_m128(_mm_set1_ps(v1[1]), _mm_set1_ps(v0[1]));
+                    const auto acc = fnmadd(im, mt[0], _mm256_mul_ps(re, m[0]));
+                    const auto out = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+                    _mm_storel_pi(reinterpret_cast<__m64 *>(&psi[I]), out);
+                    _mm_storeh_pi(reinterpret_cast<__m64 *>(&psi[I + d[0]]), out);
+                }
+                else {
+                    UINT off[dim];
+                    off[0] = 0;
+                    for (unsigned l = 0; l < N; ++l) {
+                        for (unsigned j = 0; j < (1U << l); ++j) {
+                            off[j + (1U << l)] = off[j] + d[l];
+                        }
+                    }
+
+                    __m256 acc[rows];
+                    for (unsigned r = 0; r < rows; ++r) {
+                        acc[r] = _mm256_setzero_ps();
+                    }
+
+                    for (unsigned j = 0; j < dim; ++j) {
+                        const auto *v = reinterpret_cast<const float *>(&psi[I + off[j]]);
+                        const auto re = _mm256_set1_ps(v[0]);
+                        const auto im = _mm256_set1_ps(v[1]);
+                        for (unsigned r = 0; r < rows; ++r) {
+                            acc[r] = fmadd(re, m[j * rows + r], acc[r]);
+                            acc[r] = fnmadd(im, mt[j * rows + r], acc[r]);
+                        }
+                    }
+
+                    for (unsigned r = 0; r < rows; ++r) {
+                        alignas(32) std::complex<float> out[4];
+                        _mm256_store_ps(reinterpret_cast<float *>(out), acc[r]);
+                        for (unsigned k = 0; k < 4; ++k) {
+                            psi[I + off[4 * r + k]] = out[k];
+                        }
+                    }
+                }
+            }
+
+            template <typename M>
+            static inline auto create_m(M const &m)
+            {
+                utils::intrin_float_array<num_regs> res;
+                if constexpr (N == 1) {
+                    res[0] = set4(at<dim>(m, 0, 0), at<dim>(m, 1, 0), at<dim>(m, 0, 1), at<dim>(m, 1, 1));
+                }
+                else {
+                    for (unsigned j = 0; j < dim; ++j) {
+                        for (unsigned r = 0; r < rows; ++r) {
+                            res[j * rows + r] = set4(at<dim>(m, 4 * r, j), at<dim>(m, 4 * r + 1, j),
+                                                     at<dim>(m, 4 * r + 2, j), at<dim>(m, 4 * r + 3, j));
+                        }
+                    }
+                }
+                return res;
+            }
+        };
+#endif  // __AVX2__
+    }  // namespace single
+}  // namespace details
+
+#endif /* VECTOR_SINGLE_PRECISION_HPP */
@@ -0,0 +1,22 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef VECTOR_AVX512_KERNEL1_HPP
+#define VECTOR_AVX512_KERNEL1_HPP
+
+// A single-qubit gate only has two rows: the AVX2 kernel already fills a whole 256-bit register per input amplitude
+// and there is nothing to gain from wider registers.
+#include "../vector/kernel1.hpp"
+
+#endif /* VECTOR_AVX512_KERNEL1_HPP */
@@ -0,0 +1,39 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef VECTOR_AVX512_KERNEL2_HPP
+#define VECTOR_AVX512_KERNEL2_HPP
+
+#include "utils.hpp"
+
+namespace details
+{
+    class kernel2 : public avx512::kernel<2>
+    {
+    public:
+        // bit indices id[.] are given from high to low (e.g. control first for CNOT)
+        template <class V, class M, typename UINT, int CTRLMASK>
+        static inline void dispatch(V &psi, M const &m, UINT ctrlmask, const unsigned *id)
+        {
+            if constexpr (single::is_single_precision_v<V>) {
+                kernel_dispatch<2, single::kernel<2>, CTRLMASK>(psi, m, ctrlmask, id);
+            }
+            else {
+                kernel_dispatch<2, kernel2, CTRLMASK>(psi, m, ctrlmask, id);
+            }
+        }
+    };
+}  // namespace details
+
+#endif /* VECTOR_AVX512_KERNEL2_HPP */
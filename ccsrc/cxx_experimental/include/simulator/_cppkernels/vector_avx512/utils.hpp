@@ -0,0 +1,111 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef VECTOR_AVX512_UTILS_HPP
+#define VECTOR_AVX512_UTILS_HPP
+
+#include "../vector/single_precision.hpp"
+#include "../vector/utils.hpp"
+
+#include <immintrin.h>
+
+#include <complex>
+#include <cstddef>
+
+namespace details
+{
+    namespace avx512
+    {
+        // Store the four complex numbers of a register at (possibly non-contiguous) locations
+        template <typename T>
+        inline void store4(T *p0, T *p1, T *p2, T *p3, __m512d v)
+        {
+            const auto lo = _mm512_castpd512_pd256(v);
+            const auto hi = _mm512_extractf64x4_pd(v, 1);
+            _mm_storeu_pd(reinterpret_cast<double *>(p0), _mm256_castpd256_pd128(lo));
+            _mm_storeu_pd(reinterpret_cast<double *>(p1), _mm256_extractf128_pd(lo, 1));
+            _mm_storeu_pd(reinterpret_cast<double *>(p2), _mm256_castpd256_pd128(hi));
+            _mm_storeu_pd(reinterpret_cast<double *>(p3), _mm256_extractf128_pd(hi, 1));
+        }
+
+        // Dense kernel for N >= 2 qubits using AVX-512 registers
+        //
+        // Each register holds four consecutive rows of a column of the matrix (i.e. two pairs of complex numbers per
+        // 256-bit lane) so that a single FMA updates four output amplitudes at once. The input amplitudes are
+        // broadcast to all the lanes as (re, re, ...) and (im, im, ...), which removes the horizontal operations of
+        // the AVX2 kernels:
+        //     out[r] += re(v[j]) * m[r][j] - im(v[j]) * mt[r][j]
+        // with mt = (im(m), -re(m)) as computed by utils::make_hermitian_array().
+        template <unsigned N>
+        class kernel
+        {
+        public:
+            static_assert(N >= 2, "AVX-512 kernels require at least 4 rows per matrix");
+
+            static constexpr auto dim = 1U << N;
+            static constexpr auto rows = dim / 4U;
+
+            template <class V, class M, typename UINT, typename D>
+            static inline void core(V &psi, UINT I, const D d, M const &m_tuple)
+            {
+                const auto &[m, mt] = m_tuple;
+
+                UINT off[dim];
+                off[0] = 0;
+                for (unsigned l = 0; l < N; ++l) {
+                    for (unsigned j = 0; j < (1U << l); ++j) {
+                        off[j + (1U << l)] = off[j] + d[l];
+                    }
+                }
+
+                __m512d acc[rows];
+                for (unsigned r = 0; r < rows; ++r) {
+                    acc[r] = _mm512_setzero_pd();
+                }
+
+                for (unsigned j = 0; j < dim; ++j) {
+                    const auto *v = reinterpret_cast<const double *>(&psi[I + off[j]]);
+                    const auto re = _mm512_set1_pd(v[0]);
+                    const auto im = _mm512_set1_pd(v[1]);
+                    for (unsigned r = 0; r < rows; ++r) {
+                        acc[r] = _mm512_fmadd_pd(re, m[j * rows + r], acc[r]);
+                        acc[r] = _mm512_fnmadd_pd(im, mt[j * rows + r], acc[r]);
+                    }
+                }
+
+                for (unsigned r = 0; r < rows; ++r) {
+                    store4(&psi[I + off[4 * r]], &psi[I + off[4 * r + 1]], &psi[I + off[4 * r + 2]],
+                           &psi[I + off[4 * r + 3]], acc[r]);
+                }
+            }
+
+            template <typename M>
+            static inline auto create_m(M const &m)
+            {
+                utils::intrin512_array<dim * rows> res;
+                for (unsigned j = 0; j < dim; ++j) {
+                    for (unsigned r = 0; r < rows; ++r) {
+                        const std::complex<double> c[4] = {at<dim>(m, 4 * r, j), at<dim>(m, 4 * r + 1, j),
+                                                           at<dim>(m, 4 * r + 2, j), at<dim>(m, 4 * r + 3, j)};
+                        res[j * rows + r] = _mm512_setr_pd(c[0].real(), c[0].imag(), c[1].real(), c[1].imag(),
+                                                           c[2].real(), c[2].imag(), c[3].real(), c[3].imag());
+                    }
+                }
+                return res;
+            }
+        };
+    }  // namespace avx512
+}  // namespace details
+
+#endif /* VECTOR_AVX512_UTILS_HPP */
@@ -0,0 +1,230 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef ADJOINT_GRADIENT_HPP
+#define ADJOINT_GRADIENT_HPP
+
+#include "fusion.hpp"
+#include "pauli_sum.hpp"
+
+#include <algorithm>
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace adjoint
+{
+    // A gate of a parametrized circuit, as seen by the adjoint method
+    //
+    // derivatives contains one (k, dU/dp_k) pair per parameter p_k the matrix depends on, the chain rule being already
+    // applied (i.e. dU/dp_k = dU/dtheta * dtheta/dp_k for a gate with angle theta(p)). All the matrices are stored
+    // row-major, bit l of their local index corresponding to qubit ids[l]. The derivative of a controlled gate is the
+    // derivative of its matrix projected onto the control subspace.
+    struct Gate
+    {
+        using Matrix = fusion::Fusion::Matrix;
+
+        Matrix matrix;
+        std::vector<unsigned> ids;
+        std::vector<unsigned> ctrls;
+        std::vector<std::pair<std::size_t, Matrix>> derivatives;
+    };
+
+    struct Result
+    {
+        double value;
+        std::vector<double> gradient;
+    };
+
+    namespace details
+    {
+        static constexpr auto max_targets = 5U;
+        static constexpr std::size_t max_parts = 256;
+
+        // One step of the backward sweep over the circuit:
+        //     phi <- U^dagger phi
+        //     grad[k] += 2 Re <lambda|dU/dp_k|phi>  for all the parameters of the gate
+        //     lambda <- U^dagger lambda
+        // performed group by group in a single pass over both state vectors (dU/dp_k phi is never stored).
+        template <class V>
+        void backward_step(V& phi, V& lambda, Gate const& gate, std::vector<double>& grad)
+        {
+            using value_t = typename V::value_type;
+            using complex_t = std::complex<double>;
+
+            const auto nids = static_cast<unsigned>(gate.ids.size());
+            const auto dim = std::size_t(1) << nids;
+            const auto nder = gate.derivatives.size();
+
+            // U^dagger
+            std::array<complex_t, (1U << max_targets) * (1U << max_targets)> udag;
+            for (std::size_t r = 0; r < dim; ++r) {
+                for (std::size_t c = 0; c < dim; ++c) {
+                    udag[r * dim + c] = std::conj(gate.matrix[c * dim + r]);
+                }
+            }
+
+            std::array<std::size_t, 1U << max_targets> offsets{};
+            for (std::size_t j = 0; j < dim; ++j) {
+                for (unsigned l = 0; l < nids; ++l) {
+                    if (((j >> l) & 1U) != 0) {
+                        offsets[j] |= std::size_t(1) << gate.ids[l];
+                    }
+                }
+            }
+            auto sorted = gate.ids;
+            std::sort(begin(sorted), end(sorted));
+            std::size_t ctrlmask = 0;
+            for (auto ctrl: gate.ctrls) {
+                ctrlmask |= std::size_t(1) << ctrl;
+            }
+
+            const auto ngroups = static_cast<std::size_t>(phi.size()) >> nids;
+            const auto num_parts = std::max<std::size_t>(1, std::min(ngroups, max_parts));
+            const auto part_size = (ngroups + num_parts - 1) / num_parts;
+
+            // Partial sums per part of the state vectors (avoids array reductions)
+            std::vector<double> partial(num_parts * nder, 0.);
+
+#pragma omp parallel for schedule(static)
+            for (std::size_t part = 0; part < num_parts; ++part) {
+                std::array<complex_t, 1U << max_targets> v_phi;
+                std::array<complex_t, 1U << max_targets> v_lambda;
+                std::array<complex_t, 1U << max_targets> w_phi;
+                auto* acc = partial.data() + part * nder;
+                const auto last = std::min(ngroups, (part + 1) * part_size);
+                for (std::size_t g = part * part_size; g < last; ++g) {
+                    // Insert a zero bit at the position of each target qubit
+                    auto base = g;
+                    for (unsigned l = 0; l < nids; ++l) {
+                        const auto low = (std::size_t(1) << sorted[l]) - 1U;
+                        base = ((base & ~low) << 1U) | (base & low);
+                    }
+                    if ((base & ctrlmask) != ctrlmask) {
+                        continue;
+                    }
+
+                    for (std::size_t j = 0; j < dim; ++j) {
+                        v_phi[j] = complex_t(phi[base + offsets[j]]);
+                        v_lambda[j] = complex_t(lambda[base + offsets[j]]);
+                    }
+                    for (std::size_t r = 0; r < dim; ++r) {
+                        complex_t p = 0.;
+                        for (std::size_t c = 0; c < dim; ++c) {
+                            p += udag[r * dim + c] * v_phi[c];
+                        }
+                        w_phi[r] = p;
+                    }
+                    for (std::size_t k = 0; k < nder; ++k) {
+                        const auto& d = gate.derivatives[k].second;
+                        double sum = 0.;
+                        for (std::size_t r = 0; r < dim; ++r) {
+                            complex_t p = 0.;
+                            for (std::size_t c = 0; c < dim; ++c) {
+                                p += d[r * dim + c] * w_phi[c];
+                            }
+                            sum += std::real(std::conj(v_lambda[r]) * p);
+                        }
+                        acc[k] += sum;
+                    }
+                    for (std::size_t r = 0; r < dim; ++r) {
+                        complex_t l = 0.;
+                        for (std::size_t c = 0; c < dim; ++c) {
+                            l += udag[r * dim + c] * v_lambda[c];
+                        }
+                        phi[base + offsets[r]] = value_t(w_phi[r]);
+                        lambda[base + offsets[r]] = value_t(l);
+                    }
+                }
+            }
+
+            for (std::size_t k = 0; k < nder; ++k) {
+                double sum = 0.;
+                for (std::size_t part = 0; part < num_parts; ++part) {
+                    sum += partial[part * nder + k];
+                }
+                grad[gate.derivatives[k].first] += 2. * sum;
+            }
+        }
+
+        inline void check_gate(Gate const& gate, std::size_t num_params)
+        {
+            const auto nids = gate.ids.size();
+            if (nids == 0 || nids > max_targets) {
+                throw std::invalid_argument("adjoint::gradient(): unsupported number of target qubits!");
+            }
+            const auto size = (std::size_t(1) << nids) * (std::size_t(1) << nids);
+            if (gate.matrix.size() != size) {
+                throw std::invalid_argument("adjoint::gradient(): matrix size mismatch!");
+            }
+            for (auto const& [k, d]: gate.derivatives) {
+                if (k >= num_params) {
+                    throw std::out_of_range("adjoint::gradient(): parameter index out of range!");
+                }
+                if (d.size() != size) {
+                    throw std::invalid_argument("adjoint::gradient(): derivative matrix size mismatch!");
+                }
+            }
+        }
+    }  // namespace details
+
+    //! Compute <psi|H|psi> and its gradient with respect to all the parameters of a circuit with the adjoint method
+    /*!
+     * psi = U_L ... U_1 psi_0 must be the state obtained by applying the gates of the circuit (in order) on some
+     * initial state psi_0. The circuit is then undone gate by gate on a copy of psi while a second state
+     * lambda = U_{l+1}^dagger ... U_L^dagger H psi is propagated alongside, each step contributing
+     * 2 Re <lambda|dU_l/dp_k|U_{l-1} ... U_1 psi_0> to the derivative with respect to p_k. All the gradients are thus
+     * obtained with a single backward sweep (one pass over two state vectors per gate), independently of the number
+     * of parameters.
+     *
+     * \param psi Final state of the circuit (left untouched)
+     * \param circuit Gates of the circuit, in the order in which they were applied
+     * \param op Hermitian operator H
+     * \param num_params Number of parameters of the circuit (size of the gradient)
+     * \param phi, lambda Work buffers (resized as needed)
+     */
+    template <class V>
+    Result gradient(V const& psi, std::vector<Gate> const& circuit, pauli::CompiledPauliSum const& op,
+                    std::size_t num_params, V& phi, V& lambda)
+    {
+        for (auto const& gate: circuit) {
+            details::check_gate(gate, num_params);
+        }
+
+        phi.resize(psi.size());
+        std::copy(begin(psi), end(psi), begin(phi));
+        op.apply(phi, lambda);
+
+        double value = 0.;
+#pragma omp parallel for reduction(+ : value) schedule(static)
+        for (std::size_t i = 0; i < phi.size(); ++i) {
+            value += std::real(std::conj(std::complex<double>(phi[i])) * std::complex<double>(lambda[i]));
+        }
+
+        // NB: the gates located before the first parametrized gate do not need to be undone
+        const auto first = std::find_if(begin(circuit), end(circuit),
+                                        [](auto const& gate) { return !gate.derivatives.empty(); });
+        Result res{value, std::vector<double>(num_params, 0.)};
+        for (auto it = circuit.rbegin(); it != std::make_reverse_iterator(first); ++it) {
+            details::backward_step(phi, lambda, *it, res.gradient);
+        }
+        return res;
+    }
+}  // namespace adjoint
+
+#endif /* ADJOINT_GRADIENT_HPP */
@@ -211,6 +211,26 @@ inline void aligned_free(void* ptr)
 #endif
 }
 
+namespace detail
+{
+    // Allocations above this size are usually served with fresh pages by the OS
+    static constexpr size_t first_touch_threshold = 1UL << 20U;
+    static constexpr size_t first_touch_page_size = 4096;
+
+    // Write to each page of a large allocation from the OpenMP thread that processes it in the (statically scheduled)
+    // loops over the state vector, so that the OS places the page on the NUMA node of that thread (first-touch
+    // policy) instead of the node of the thread that happened to zero-initialise the vector.
+    inline void first_touch(void* ptr, size_t size)
+    {
+        auto* bytes = static_cast<char*>(ptr);
+        const auto num_pages = size / first_touch_page_size;
+#pragma omp parallel for schedule(static)
+        for (size_t page = 0; page < num_pages; ++page) {
+            bytes[page * first_touch_page_size] = 0;  // NOLINT
+        }
+    }
+}  // namespace detail
+
 template <class T, unsigned int alignment>
 // NOLINTNEXTLINE(huawei-force-type-void)
 auto aligned_allocator<T, alignment>::allocate(size_type n, const void* /* hint */) const
@@ -220,6 +240,9 @@ auto aligned_allocator<T, alignment>::allocate(size_type n, const void* /* hint
     if (res == nullptr) {
         throw std::bad_alloc();
     }
+    if (sizeof(T) * n >= detail::first_touch_threshold) {
+        detail::first_touch(res, sizeof(T) * n);
+    }
     return res;
 }
 
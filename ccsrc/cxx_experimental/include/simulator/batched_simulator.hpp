@@ -0,0 +1,315 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef BATCHED_SIMULATOR_HPP
+#define BATCHED_SIMULATOR_HPP
+
+#include "aligned_allocator.hpp"
+#include "fusion.hpp"
+#include "pauli_sum.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace batched
+{
+    // Simulator holding a batch of B state vectors on the same qubits, e.g. to evaluate the same circuit for many
+    // parameter vectors
+    //
+    // The amplitudes are stored as [amplitude][batch] (split into real and imaginary parts), so that the B values of
+    // a given amplitude are contiguous. Gates are applied on all the states at once; each gate may use a different
+    // matrix for each element of the batch. The innermost loops run over the batch dimension, with contiguous loads
+    // and stores for both the amplitudes and the matrix elements, which vectorizes well (SIMD across the batch) and
+    // reuses each index computation B times. For small numbers of qubits this is much more cache and SIMD friendly
+    // than B independent simulators.
+    template <typename calc_t = double>
+    class BatchedSimulator
+    {
+    public:
+        using complex_type = std::complex<calc_t>;
+        using Matrix = fusion::Fusion::Matrix;
+        using Buffer = std::vector<calc_t, aligned_allocator<calc_t, 64>>;
+        using StateVector = std::vector<complex_type>;
+
+        static constexpr auto max_targets = 5U;
+
+        //! All states initialized to |0...0>
+        BatchedSimulator(unsigned num_qubits, std::size_t batch_size)
+            : num_qubits_(num_qubits)
+            , batch_(batch_size)
+            , re_((std::size_t(1) << num_qubits) * batch_size, 0.)
+            , im_(re_.size(), 0.)
+        {
+            if (batch_ == 0) {
+                throw std::invalid_argument("BatchedSimulator: batch size must be > 0!");
+            }
+            std::fill_n(begin(re_), batch_, calc_t(1.));
+        }
+
+        [[nodiscard]] unsigned num_qubits() const
+        {
+            return num_qubits_;
+        }
+        [[nodiscard]] std::size_t batch_size() const
+        {
+            return batch_;
+        }
+        [[nodiscard]] std::size_t dim() const
+        {
+            return std::size_t(1) << num_qubits_;
+        }
+
+        //! Return state b of the batch
+        [[nodiscard]] StateVector get_state(std::size_t b) const
+        {
+            check_batch_index(b);
+            StateVector psi(dim());
+            for (std::size_t i = 0; i < psi.size(); ++i) {
+                psi[i] = {re_[i * batch_ + b], im_[i * batch_ + b]};
+            }
+            return psi;
+        }
+
+        //! Set state b of the batch
+        template <class V>
+        void set_state(std::size_t b, V const& psi)
+        {
+            check_batch_index(b);
+            if (psi.size() != dim()) {
+                throw std::invalid_argument("set_state(): size mismatch!");
+            }
+            for (std::size_t i = 0; i < psi.size(); ++i) {
+                re_[i * batch_ + b] = static_cast<calc_t>(std::real(psi[i]));
+                im_[i * batch_ + b] = static_cast<calc_t>(std::imag(psi[i]));
+            }
+        }
+
+        //! Apply a gate on all the states of the batch
+        /*!
+         * \param ids Target qubits (bit l of the local index of the matrices corresponds to qubit ids[l])
+         * \param matrices Either a single matrix used for all the states or one matrix per state
+         * \param ctrls Control qubits
+         */
+        void apply_gate(std::vector<unsigned> const& ids, std::vector<Matrix> const& matrices,
+                        std::vector<unsigned> const& ctrls = {})
+        {
+            const auto nids = static_cast<unsigned>(ids.size());
+            if (nids == 0 || nids > max_targets) {
+                throw std::invalid_argument("apply_gate(): unsupported number of target qubits!");
+            }
+            if (matrices.size() != 1 && matrices.size() != batch_) {
+                throw std::invalid_argument("apply_gate(): expected one matrix or one matrix per state!");
+            }
+            check_qubits(ids, ctrls);
+            const auto gdim = std::size_t(1) << nids;
+            std::size_t ctrlmask = 0;
+            for (auto ctrl: ctrls) {
+                ctrlmask |= std::size_t(1) << ctrl;
+            }
+
+            // Matrix elements as [row][column][batch]
+            Buffer m_re(gdim * gdim * batch_);
+            Buffer m_im(gdim * gdim * batch_);
+            for (std::size_t b = 0; b < batch_; ++b) {
+                const auto& m = matrices[matrices.size() == 1 ? 0 : b];
+                if (m.size() != gdim * gdim) {
+                    throw std::invalid_argument("apply_gate(): matrix size mismatch!");
+                }
+                for (std::size_t e = 0; e < gdim * gdim; ++e) {
+                    m_re[e * batch_ + b] = static_cast<calc_t>(m[e].real());
+                    m_im[e * batch_ + b] = static_cast<calc_t>(m[e].imag());
+                }
+            }
+
+            // Offsets of the amplitudes of a group and target qubits sorted in increasing order
+            std::array<std::size_t, 1U << max_targets> offsets{};
+            for (std::size_t j = 0; j < gdim; ++j) {
+                for (unsigned l = 0; l < nids; ++l) {
+                    if (((j >> l) & 1U) != 0) {
+                        offsets[j] |= std::size_t(1) << ids[l];
+                    }
+                }
+            }
+            auto sorted = ids;
+            std::sort(begin(sorted), end(sorted));
+
+            const auto ngroups = dim() >> nids;
+            const auto num_parts = std::min(ngroups, max_parts);
+            const auto part_size = (ngroups + num_parts - 1) / num_parts;
+            const auto B = batch_;
+            calc_t* re = re_.data();
+            calc_t* im = im_.data();
+
+#pragma omp parallel for schedule(static)
+            for (std::size_t part = 0; part < num_parts; ++part) {
+                Buffer v_re(gdim * B);
+                Buffer v_im(gdim * B);
+                const auto last = std::min(ngroups, (part + 1) * part_size);
+                for (std::size_t g = part * part_size; g < last; ++g) {
+                    // Insert a zero bit at the position of each target qubit
+                    auto base = g;
+                    for (unsigned l = 0; l < nids; ++l) {
+                        const auto low = (std::size_t(1) << sorted[l]) - 1U;
+                        base = ((base & ~low) << 1U) | (base & low);
+                    }
+                    if ((base & ctrlmask) != ctrlmask) {
+                        continue;
+                    }
+
+                    for (std::size_t j = 0; j < gdim; ++j) {
+                        std::copy_n(re + (base + offsets[j]) * B, B, v_re.data() + j * B);
+                        std::copy_n(im + (base + offsets[j]) * B, B, v_im.data() + j * B);
+                    }
+                    for (std::size_t r = 0; r < gdim; ++r) {
+                        auto* out_re = re + (base + offsets[r]) * B;
+                        auto* out_im = im + (base + offsets[r]) * B;
+                        std::fill_n(out_re, B, calc_t(0.));
+                        std::fill_n(out_im, B, calc_t(0.));
+                        for (std::size_t j = 0; j < gdim; ++j) {
+                            const auto* mr = m_re.data() + (r * gdim + j) * B;
+                            const auto* mi = m_im.data() + (r * gdim + j) * B;
+                            const auto* vr = v_re.data() + j * B;
+                            const auto* vi = v_im.data() + j * B;
+#pragma omp simd
+                            for (std::size_t b = 0; b < B; ++b) {
+                                out_re[b] += mr[b] * vr[b] - mi[b] * vi[b];
+                                out_im[b] += mr[b] * vi[b] + mi[b] * vr[b];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        //! Apply exp(-i theta_b / 2 P) on qubit id of each state b, with P = 'X', 'Y' or 'Z'
+        void apply_rotation(char pauli, unsigned id, std::vector<double> const& angles,
+                            std::vector<unsigned> const& ctrls = {})
+        {
+            const std::complex<double> I(0., 1.);
+            std::vector<Matrix> matrices;
+            matrices.reserve(angles.size());
+            for (auto theta: angles) {
+                const auto c = std::cos(theta / 2.);
+                const auto s = std::sin(theta / 2.);
+                switch (pauli) {
+                    case 'X':
+                        matrices.push_back({c, -I * s, -I * s, c});
+                        break;
+                    case 'Y':
+                        matrices.push_back({c, -s, s, c});
+                        break;
+                    case 'Z':
+                        matrices.push_back({std::polar(1., -theta / 2.), 0., 0., std::polar(1., theta / 2.)});
+                        break;
+                    default:
+                        throw std::invalid_argument("apply_rotation(): invalid Pauli operator!");
+                }
+            }
+            apply_gate({id}, matrices, ctrls);
+        }
+
+        //! Compute Re(<psi_b|H|psi_b>) for each state of the batch in a single read-only pass
+        [[nodiscard]] std::vector<double> expectation(pauli::CompiledPauliSum const& op) const
+        {
+            const auto num_groups = op.num_groups();
+
+            const auto size = dim();
+            const auto num_parts = std::min(size, max_parts);
+            const auto part_size = (size + num_parts - 1) / num_parts;
+            const auto B = batch_;
+            const calc_t* re = re_.data();
+            const calc_t* im = im_.data();
+
+            // Partial sums per part of the state vectors (avoids array reductions)
+            std::vector<double> partial(num_parts * B, 0.);
+#pragma omp parallel for schedule(static)
+            for (std::size_t part = 0; part < num_parts; ++part) {
+                std::vector<double> row_re(B);
+                std::vector<double> row_im(B);
+                auto* acc = partial.data() + part * B;
+                const auto last = std::min(size, (part + 1) * part_size);
+                for (std::size_t i = part * part_size; i < last; ++i) {
+                    // (H psi_b)[i] for all b
+                    std::fill(begin(row_re), end(row_re), 0.);
+                    std::fill(begin(row_im), end(row_im), 0.);
+                    for (std::size_t g = 0; g < num_groups; ++g) {
+                        const auto j = i ^ op.group_x_mask(g);
+                        const auto c = op.group_coeff(g, j);
+                        const auto* vr = re + j * B;
+                        const auto* vi = im + j * B;
+#pragma omp simd
+                        for (std::size_t b = 0; b < B; ++b) {
+                            row_re[b] += c.real() * vr[b] - c.imag() * vi[b];
+                            row_im[b] += c.real() * vi[b] + c.imag() * vr[b];
+                        }
+                    }
+                    const auto* ur = re + i * B;
+                    const auto* ui = im + i * B;
+#pragma omp simd
+                    for (std::size_t b = 0; b < B; ++b) {
+                        acc[b] += ur[b] * row_re[b] + ui[b] * row_im[b];
+                    }
+                }
+            }
+
+            std::vector<double> values(B, 0.);
+            for (std::size_t part = 0; part < num_parts; ++part) {
+                for (std::size_t b = 0; b < B; ++b) {
+                    values[b] += partial[part * B + b];
+                }
+            }
+            return values;
+        }
+
+    private:
+        static constexpr std::size_t max_parts = 256;
+
+        void check_batch_index(std::size_t b) const
+        {
+            if (b >= batch_) {
+                throw std::out_of_range("BatchedSimulator: batch index out of range!");
+            }
+        }
+
+        // Same requirements as BasicSimulator: known qubits, each used at most once as target or control
+        void check_qubits(std::vector<unsigned> const& ids, std::vector<unsigned> const& ctrls) const
+        {
+            std::size_t used = 0;
+            for (auto const* qubits: {&ids, &ctrls}) {
+                for (auto qubit: *qubits) {
+                    if (qubit >= num_qubits_) {
+                        throw std::invalid_argument("apply_gate(): qubit index out of range!");
+                    }
+                    const auto bit = std::size_t(1) << qubit;
+                    if ((used & bit) != 0) {
+                        throw std::invalid_argument("apply_gate(): qubit used more than once!");
+                    }
+                    used |= bit;
+                }
+            }
+        }
+
+        unsigned num_qubits_;
+        std::size_t batch_;
+        Buffer re_;
+        Buffer im_;
+    };
+}  // namespace batched
+
+#endif /* BATCHED_SIMULATOR_HPP */
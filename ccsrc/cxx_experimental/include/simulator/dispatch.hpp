@@ -20,12 +20,16 @@
 #include "kernel_counter.hpp"
 #include "to_array.hpp"
 
+#include <array>
+#include <algorithm>
 #include <climits>
 #include <complex>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <iostream>
+#include <stdexcept>
+#include <string>
 #include <tuple>
 #include <type_traits>
 
@@ -45,7 +49,8 @@ namespace details
     template <unsigned int N, typename M>
     inline const auto& toArray(M const& m)
     {
-        return *reinterpret_cast<const std::array<std::array<std::complex<double>, 1UL << N>, 1UL << N>*>(&m[0]);
+        using value_t = std::remove_cv_t<std::remove_reference_t<decltype(m[0])>>;
+        return *reinterpret_cast<const std::array<std::array<value_t, 1UL << N>, 1UL << N>*>(&m[0]);
     }
 
     template <int N, typename UINT>
@@ -96,40 +101,119 @@ namespace traits
     }
 }  // namespace traits
 
+namespace details
+{
+    // Positions of the control qubits of a gate within the loop index of kernel_loop()
+    //
+    // Instead of enumerating all the indices and testing them against the control mask, the control bits are inserted
+    // (set to 1) into the loop index before it is decomposed around the target qubits. Only the indices that satisfy
+    // the controls are therefore enumerated.
+    template <typename UINT>
+    struct ctrl_insertion
+    {
+        ctrl_insertion() = default;
+
+        // ds: 2^(p+1) for each target qubit p, sorted in decreasing order
+        // bitSize: number of bits of each part of the loop index (see kernel_dispatch())
+        template <std::size_t N>
+        ctrl_insertion(UINT ctrlmask, const std::array<UINT, N>& ds, const std::array<unsigned, N + 1>& bitSize)
+        {
+            // Part jj < N of the loop index holds the bits located above target qubit jj (and below target jj-1),
+            // while the last part holds the bits below the lowest target qubit.
+            std::array<unsigned, N + 1> bitOffset{};
+            for (std::size_t jj = 1; jj < N + 1; ++jj) {
+                bitOffset[jj] = bitOffset[jj - 1] + bitSize[jj - 1];
+            }
+
+            for (unsigned bit = 0; bit < CHAR_BIT * sizeof(UINT); ++bit) {
+                if (((ctrlmask >> bit) & 1U) == 0U) {
+                    continue;
+                }
+                const auto ctrl = UINT(1) << bit;
+                std::size_t jj = 0;
+                while (jj < N && ds[jj] > ctrl) {
+                    ++jj;
+                }
+                const auto low = jj < N ? static_cast<unsigned>(__builtin_ctzll(ds[jj])) : 0U;
+                pos[count++] = bitOffset[jj] + bit - low;
+            }
+            std::sort(begin(pos), begin(pos) + count);
+            for (unsigned c = 0; c < count; ++c) {
+                mask |= UINT(1) << pos[c];
+            }
+        }
+
+        // Same for a loop index made of the bits of all the non-target qubits, in increasing order
+        // (sorted: indices of the target qubits, sorted in increasing order)
+        ctrl_insertion(UINT ctrlmask, const unsigned* sorted, unsigned nids)
+        {
+            for (unsigned bit = 0; bit < CHAR_BIT * sizeof(UINT); ++bit) {
+                if (((ctrlmask >> bit) & 1U) == 0U) {
+                    continue;
+                }
+                const auto below = static_cast<unsigned>(std::lower_bound(sorted, sorted + nids, bit) - sorted);
+                pos[count++] = bit - below;
+            }
+            for (unsigned c = 0; c < count; ++c) {
+                mask |= UINT(1) << pos[c];
+            }
+        }
+
+        // Insert the control bits at their position into index ii (positions are sorted in increasing order)
+        template <typename BITMASK>
+        [[nodiscard]] UINT apply(const BITMASK& ii) const
+        {
+            UINT i = ii;
+            for (unsigned c = 0; c < count; ++c) {
+                const auto low = (UINT(1) << pos[c]) - 1U;
+                i = ((i & ~low) << 1U) | (i & low);
+            }
+            return i | mask;
+        }
+
+        unsigned count = 0;
+        std::array<unsigned, CHAR_BIT * sizeof(UINT)> pos{};
+        UINT mask = 0;
+    };
+}  // namespace details
+
 template <int N, typename K, int CTRLMASK, typename UINT, typename BITMASK, class V, class M, typename D, typename BM,
           typename BO>
-inline void kernel_body(const BITMASK& ii, const BM bitMask, const BO bitOffset, V psi, M const& m_,
-                        const UINT ctrlmask, const D d, const D ds)
+inline void kernel_body(const BITMASK& ii_, const BM bitMask, const BO bitOffset, V psi, M const& m_,
+                        const details::ctrl_insertion<UINT>& ctrl, const D d, const D ds)
 {
     const auto& m = traits::get_m<N>(m_);
 
+    // Controls are set to 1 in the index, so all the enumerated indices satisfy them
+    UINT ii = ii_;
+    if constexpr (CTRLMASK != 0) {  // NOLINT: old version of clang-tidy do not handle this well...
+        ii = ctrl.apply(ii_);
+    }
+
     // TODO(damien): Can further use SIMD here
     UINT i = (ii & bitMask[N]) >> bitOffset[N];
     for (int jj = 0; jj < N; jj++) {
         i += ((ii & bitMask[jj]) >> bitOffset[jj]) * ds[jj];
     }
 
-    if constexpr (CTRLMASK == 0) {  // NOLINT: old version of clang-tidy do not handle this well...
-        K::core(psi, i, d, m);
-    }
-    else {
-        if ((i & ctrlmask) == ctrlmask) {
-            K::core(psi, i, d, m);
-        }
-    }
+    K::core(psi, i, d, m);
 }
 
 template <typename BITMASK, typename BITMASK_DIFF, int N, typename K, int CTRLMASK, class V, class M, typename UINT>
 inline void kernel_loop(const BITMASK& maskBitSize, const std::array<unsigned, N + 1>& bitSize, V& psi_, M const& m_,
-                        const UINT ctrlmask, const std::array<UINT, N>& d, const std::array<UINT, N>& ds)
+                        const details::ctrl_insertion<UINT>& ctrl, const std::array<UINT, N>& d,
+                        const std::array<UINT, N>& ds)
 {
-    const BITMASK upperBound = (CHAR_BIT * sizeof(BITMASK) == maskBitSize) ? ~BITMASK(0U)
-                                                                           : (BITMASK(1U) << maskBitSize) - 1U;
+    // NB: the control bits are fixed, hence not part of the loop index
+    const auto loopBitSize = static_cast<unsigned>(maskBitSize) - ctrl.count;
+    const BITMASK upperBound = (CHAR_BIT * sizeof(BITMASK) == loopBitSize) ? ~BITMASK(0U)
+                                                                           : (BITMASK(1U) << loopBitSize) - 1U;
 
     // Generate bitmasks for multiindex parts.
     std::array<BITMASK, N + 1> bitMask;
     for (int jj = 0; jj < N + 1; jj++) {
-        bitMask[jj] = BITMASK((1 << bitSize[jj]) - 1);  // NOLINT
+        bitMask[jj] = bitSize[jj] >= CHAR_BIT * sizeof(uint64_t) ? BITMASK(~BITMASK(0U))
+                                                                 : BITMASK((uint64_t(1) << bitSize[jj]) - 1U);
     }
 
     // Shift bitmasks to position them one after another.
@@ -148,19 +232,29 @@ inline void kernel_loop(const BITMASK& maskBitSize, const std::array<unsigned, N
     const std::complex<double>* m = reinterpret_cast<const std::complex<double>*>(
         load_m_const(&m_[0], (1 << N) * (1 << N) * sizeof(m[0])));
 #else
-    std::complex<double>* psi = &psi_[0];
+    auto* psi = &psi_[0];
 #    ifdef INTRIN
     const auto tmp_ = K::create_m(m_);
     const auto m = std::make_tuple(tmp_, utils::make_hermitian_array(tmp_));
 #    else
-    const std::complex<double>* m = &m_[0];
+    // The gate matrix is always given in double precision: convert it once if the state vector is not
+    using value_t = std::remove_reference_t<decltype(*psi)>;
+    std::array<value_t, (1UL << N) * (1UL << N)> m_cast;
+    const value_t* m = nullptr;
+    if constexpr (std::is_same_v<value_t, std::remove_cv_t<std::remove_reference_t<decltype(m_[0])>>>) {
+        m = &m_[0];
+    }
+    else {
+        std::copy_n(&m_[0], m_cast.size(), begin(m_cast));
+        m = m_cast.data();
+    }
 #    endif  // INTRIN
 #endif      // HIQ_WITH_CUDA
 
     details::kernel_counter<BITMASK, BITMASK_DIFF, 0> ii(upperBound);
 
-    parallel::for_each(ii, [bitMask, bitOffset, psi, m, ctrlmask, d, ds](BITMASK ii) {
-        kernel_body<N, K, CTRLMASK, UINT>(ii, bitMask, bitOffset, psi, m, ctrlmask, d, ds);
+    parallel::for_each(ii, [bitMask, bitOffset, psi, m, ctrl, d, ds](BITMASK ii) {
+        kernel_body<N, K, CTRLMASK, UINT>(ii, bitMask, bitOffset, psi, m, ctrl, d, ds);
     });
 
 #if defined(HIQ_WITH_CUDA)
@@ -171,10 +265,14 @@ inline void kernel_loop(const BITMASK& maskBitSize, const std::array<unsigned, N
 
     // Run the last iteration separately to avoid a possible index type overflow.
     if constexpr (traits::is_tuple_v<decltype(m)>) {
-        kernel_body<N, K, CTRLMASK, UINT>(upperBound, bitMask, bitOffset, &psi_[0], m, ctrlmask, d, ds);
+        kernel_body<N, K, CTRLMASK, UINT>(upperBound, bitMask, bitOffset, &psi_[0], m, ctrl, d, ds);
     }
     else {
-        kernel_body<N, K, CTRLMASK, UINT>(upperBound, bitMask, bitOffset, &psi_[0], m_, ctrlmask, d, ds);
+#if defined(HIQ_WITH_CUDA)
+        kernel_body<N, K, CTRLMASK, UINT>(upperBound, bitMask, bitOffset, &psi_[0], m_, ctrl, d, ds);
+#else
+        kernel_body<N, K, CTRLMASK, UINT>(upperBound, bitMask, bitOffset, &psi_[0], m, ctrl, d, ds);
+#endif  // HIQ_WITH_CUDA
     }
 }
 
@@ -182,7 +280,7 @@ template <typename T>
 constexpr auto BITSIZE(T v)
 {
     if (v) {
-        return static_cast<unsigned>(CHAR_BIT) * sizeof(int) - __builtin_clz(v);
+        return static_cast<unsigned>(CHAR_BIT) * sizeof(unsigned long long) - __builtin_clzll(v);  // NOLINT
     }
     return 0UL;
 }
@@ -193,15 +291,36 @@ constexpr auto ROUNDUP(T v, U to)
     return ((v) + (to) -1U) & -(to);  // NOLINT(hicpp-signed-bitwise)
 }
 
-template <int N, typename K, int CTRLMASK, class V, class M, typename UINT>
-inline void kernel_dispatch(V& psi, M const& m, UINT ctrlmask, const unsigned* id)
+namespace details
 {
-#ifdef HIQ_WITH_CUDA
-    int device(0);
-    cudaGetDevice(&device);
-    details::global = get_memory_on_gpu(device);
-#endif  // HIQ_WITH_CUDA
+    // Number of bytes of the loop index of kernel_loop() for a given bit population
+    //
+    // Throws std::overflow_error if no integer type is large enough.
+    inline std::size_t loop_index_bytes(std::size_t maskBitSize)
+    {
+        const auto maskByteSize = ROUNDUP(maskBitSize, CHAR_BIT) / static_cast<std::size_t>(CHAR_BIT);
+        if (maskByteSize <= 1) {
+            return 1;
+        }
+        if (maskByteSize <= 2) {
+            return 2;
+        }
+        if (maskByteSize <= 4) {
+            return 4;  // NOLINT
+        }
+        if (maskByteSize <= 8) {  // NOLINT
+            return 8;             // NOLINT
+        }
+        throw std::overflow_error("The bitmask size of " + std::to_string(maskBitSize)
+                                  + " bits is larger than the largest supported loop index type (64 bits)");
+    }
+}  // namespace details
 
+// NB: BITMASK can be used to force the type of the loop index (mainly for testing); by default it is selected based on
+//     the size of the state vector.
+template <int N, typename K, int CTRLMASK, class V, class M, typename UINT, typename BITMASK = void>
+inline void kernel_dispatch(V& psi, M const& m, UINT ctrlmask, const unsigned* id)
+{
     std::array<UINT, N> d;
     std::array<UINT, N> ds;
     for (int i = 0; i < N; i++) {
@@ -224,30 +343,40 @@ inline void kernel_dispatch(V& psi, M const& m, UINT ctrlmask, const unsigned* i
         maskBitSize += bitSize[i];
         debug::printf("%zu bit size = %zu\n", static_cast<size_t>(de[i] - 1U), static_cast<size_t>(bitSize[i]));
     }
-    size_t maskByteSize = ROUNDUP(maskBitSize, CHAR_BIT) / static_cast<size_t>(CHAR_BIT);
+    const auto maskByteSize = details::loop_index_bytes(maskBitSize);
 
     debug::printf("Required bitmask size = %zu bits (%zu bytes)\n", maskBitSize, maskByteSize);
 
+    const auto ctrl = CTRLMASK == 0 ? details::ctrl_insertion<UINT>()
+                                    : details::ctrl_insertion<UINT>(ctrlmask, ds, bitSize);
+
+#ifdef HIQ_WITH_CUDA
+    int device(0);
+    cudaGetDevice(&device);
+    details::global = get_memory_on_gpu(device);
+#endif  // HIQ_WITH_CUDA
+
     // Select the loop index type, based on the required bit population
-    switch (maskByteSize) {
-        case 0:
-        case 1:
-            kernel_loop<uint8_t, int16_t, N, K, CTRLMASK>(maskBitSize, bitSize, psi, m, ctrlmask, d, ds);
-            break;
-        case 2:
-            kernel_loop<uint16_t, int32_t, N, K, CTRLMASK>(maskBitSize, bitSize, psi, m, ctrlmask, d, ds);
-            break;
-        case 3:
-        case 4:
-            kernel_loop<uint32_t, int64_t, N, K, CTRLMASK>(maskBitSize, bitSize, psi, m, ctrlmask, d, ds);
-            break;
-        case 5:  // NOLINT
-        case 6:  // NOLINT
-        case 7:  // NOLINT
-        case 8:  // NOLINT
-        default:
-            std::cerr << "The bitmask size of > 4 bytes is not supported\n";
-            exit(-1);  // NOLINT
+    if constexpr (!std::is_void_v<BITMASK>) {
+        kernel_loop<BITMASK, std::make_signed_t<BITMASK>, N, K, CTRLMASK>(maskBitSize, bitSize, psi, m, ctrl, d, ds);
+    }
+    else {
+        switch (maskByteSize) {
+            case 1:
+                kernel_loop<uint8_t, int16_t, N, K, CTRLMASK>(maskBitSize, bitSize, psi, m, ctrl, d, ds);
+                break;
+            case 2:
+                kernel_loop<uint16_t, int32_t, N, K, CTRLMASK>(maskBitSize, bitSize, psi, m, ctrl, d, ds);
+                break;
+            case 4:  // NOLINT
+                kernel_loop<uint32_t, int64_t, N, K, CTRLMASK>(maskBitSize, bitSize, psi, m, ctrl, d, ds);
+                break;
+            case 8:  // NOLINT
+            default:
+                // NB: no wider signed type available for the difference type (unused by kernel_counter anyway)
+                kernel_loop<uint64_t, int64_t, N, K, CTRLMASK>(maskBitSize, bitSize, psi, m, ctrl, d, ds);
+                break;
+        }
     }
 
 #ifdef HIQ_WITH_CUDA
@@ -17,8 +17,15 @@
 
 #include "aligned_allocator.hpp"
 
+#if defined(INTRIN) && !defined(NOINTRIN) && defined(__AVX2__)
+#    include "cintrin.hpp"
+#    define FUSION_USE_INTRIN
+#endif  // INTRIN && !NOINTRIN && __AVX2__
+
 #include <algorithm>
+#include <cmath>
 #include <complex>
+#include <cstddef>
 #include <iostream>
 #include <set>
 #include <vector>
@@ -60,11 +67,33 @@ namespace fusion
         using Matrix = std::vector<Complex, aligned_allocator<Complex, alignment>>;
         using ItemVector = std::vector<Item>;
 
-        unsigned num_qubits()
+        [[nodiscard]] unsigned num_qubits() const
         {
             return set_.size();
         }
 
+        // Number of qubits of the fused gate if a gate acting on index_list and controlled by ctrl_list were to be
+        // inserted (see handle_controls() for the rules applied to the controls).
+        [[nodiscard]] unsigned num_qubits_if_inserted(IndexVector const& index_list,
+                                                      IndexVector const& ctrl_list = {}) const
+        {
+            auto set = set_;
+            set.insert(index_list.cbegin(), index_list.cend());
+            if (!items_.empty()) {
+                for (auto ctrl: ctrl_list) {
+                    if (ctrl_set_.count(ctrl) == 0U) {
+                        set.insert(ctrl);
+                    }
+                }
+            }
+            for (auto ctrl: ctrl_set_) {
+                if (std::find(ctrl_list.cbegin(), ctrl_list.cend(), ctrl) == ctrl_list.cend()) {
+                    set.insert(ctrl);
+                }
+            }
+            return set.size();
+        }
+
         [[nodiscard]] auto size() const
         {
             return items_.size();
@@ -97,50 +126,104 @@ namespace fusion
                 M[i * dim + i] = 1.;
             }
 
+            Scratch scratch;  // shared by all the items
             for (auto& item: items_) {
-                auto dim2 = static_cast<std::size_t>(sqrt(item.get_matrix().size()));
-                auto const& idx = item.get_indices();
-                IndexVector idx2mat(idx.size());
-                for (std::size_t i = 0; i < idx.size(); ++i) {
-                    idx2mat[i] = static_cast<unsigned>(
-                        std::equal_range(index_list.begin(), index_list.end(), idx[i]).first - index_list.begin());
-                }
+                apply_item_(M, dim, item, index_list, scratch);
+            }
+            ctrl_list.reserve(ctrl_set_.size());
+            for (const auto& ctrl: ctrl_set_) {
+                ctrl_list.push_back(ctrl);
+            }
+        }
 
-                for (std::size_t k = 0; k < dim; ++k) {  // loop over big matrix columns
-                    // check if column index satisfies control-mask
-                    // if not: leave it unchanged
-                    std::vector<Complex> oldcol(1UL << N);
-                    for (std::size_t i = 0; i < (1UL << N); ++i) {
-                        oldcol[i] = M[i * dim + k];
+    private:
+        // Temporary buffers of apply_item_()
+        struct Scratch
+        {
+            std::vector<std::size_t> offsets;
+            Matrix rows;
+#ifdef FUSION_USE_INTRIN
+            std::vector<double> coeffs;
+#endif  // FUSION_USE_INTRIN
+        };
+
+        // Left-multiply the (dim x dim) fused matrix M by the matrix of item, in place
+        //
+        // The rows of M are gathered in groups of 2^m rows (m being the number of qubits of the item) that only
+        // differ in the bits the item acts on. Each group is copied into a scratch buffer once and the rows of the
+        // group are then overwritten by the small matrix-matrix product, one pair of columns at a time.
+        static void apply_item_(Matrix& M, std::size_t dim, Item& item, IndexVector const& index_list, Scratch& scratch)
+        {
+            auto const& mat = item.get_matrix();
+            auto const& idx = item.get_indices();
+            const auto nrows = static_cast<std::size_t>(std::sqrt(mat.size()));
+
+            // Offset of each row of a group w.r.t. the first one (bit l of the local index <-> idx[l])
+            std::size_t mask = 0;
+            auto& offsets = scratch.offsets;
+            offsets.assign(nrows, 0);
+            for (std::size_t l = 0; l < idx.size(); ++l) {
+                const auto pos = static_cast<std::size_t>(
+                    std::lower_bound(index_list.begin(), index_list.end(), idx[l]) - index_list.begin());
+                const auto bit = 1UL << pos;
+                mask |= bit;
+                for (std::size_t j = 0; j < nrows; ++j) {
+                    if (((j >> l) & 1UL) != 0U) {
+                        offsets[j] |= bit;
                     }
+                }
+            }
 
-                    for (std::size_t i = 0; i < (1UL << N); ++i) {
-                        std::size_t local_i = 0;
-                        for (std::size_t l = 0; l < idx.size(); ++l) {
-                            local_i |= ((i >> idx2mat[l]) & 1UL) << l;
-                        }
+            auto& rows = scratch.rows;
+            rows.resize(nrows * dim);
+
+#ifdef FUSION_USE_INTRIN
+            // Broadcast each matrix element once per item: (re, im, re, im) and (im, -re, im, -re)
+            auto& coeffs = scratch.coeffs;
+            coeffs.resize(8 * nrows * nrows);
+            for (std::size_t i = 0; i < nrows * nrows; ++i) {
+                const auto re = mat[i].real();
+                const auto im = mat[i].imag();
+                _mm256_storeu_pd(&coeffs[8 * i], _mm256_setr_pd(re, im, re, im));
+                _mm256_storeu_pd(&coeffs[8 * i + 4], _mm256_setr_pd(im, -re, im, -re));
+            }
+#endif  // FUSION_USE_INTRIN
 
-                        Complex res = 0.;
-                        for (std::size_t j = 0; j < (1UL << idx.size()); ++j) {
-                            std::size_t locidx = i;
-                            for (std::size_t l = 0; l < idx.size(); ++l) {
-                                if (((j >> l) & 1UL) != ((i >> idx2mat[l]) & 1UL)) {
-                                    locidx ^= (1UL << idx2mat[l]);
-                                }
-                            }
-                            res += oldcol[locidx] * item.get_matrix()[local_i * dim2 + j];
+            for (std::size_t base = 0; base < dim; ++base) {
+                if ((base & mask) != 0U) {
+                    continue;
+                }
+                for (std::size_t j = 0; j < nrows; ++j) {
+                    std::copy_n(&M[(base | offsets[j]) * dim], dim, &rows[j * dim]);
+                }
+                for (std::size_t i = 0; i < nrows; ++i) {
+                    auto* row = &M[(base | offsets[i]) * dim];
+#ifdef FUSION_USE_INTRIN
+                    // NB: dim >= 2 since the fused gate acts on at least one qubit
+                    for (std::size_t k = 0; k < dim; k += 2) {
+                        auto res = _mm256_setzero_pd();
+                        for (std::size_t j = 0; j < nrows; ++j) {
+                            auto const* m_ij = &coeffs[8 * (i * nrows + j)];
+                            const auto v = _mm256_loadu_pd(reinterpret_cast<double const*>(&rows[j * dim + k]));
+                            res = details::add(
+                                res, details::mul(v, _mm256_loadu_pd(m_ij), _mm256_loadu_pd(m_ij + 4)));
+                        }
+                        _mm256_storeu_pd(reinterpret_cast<double*>(&row[k]), res);
+                    }
+#else
+                    std::fill_n(row, dim, Complex{0.});
+                    for (std::size_t j = 0; j < nrows; ++j) {
+                        const auto m_ij = mat[i * nrows + j];
+                        auto const* src = &rows[j * dim];
+                        for (std::size_t k = 0; k < dim; ++k) {
+                            row[k] += m_ij * src[k];
                         }
-                        M[i * dim + k] = res;
                     }
+#endif  // FUSION_USE_INTRIN
                 }
             }
-            ctrl_list.reserve(ctrl_set_.size());
-            for (const auto& ctrl: ctrl_set_) {
-                ctrl_list.push_back(ctrl);
-            }
         }
 
-    private:
         static void add_controls(Matrix& matrix, IndexVector& indexList, IndexVector const& new_ctrls)
         {
             indexList.reserve(indexList.size() + new_ctrls.size());
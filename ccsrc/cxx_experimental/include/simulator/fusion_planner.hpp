@@ -0,0 +1,200 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef FUSION_PLANNER_HPP
+#define FUSION_PLANNER_HPP
+
+#include "fusion.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace fusion
+{
+    // A single gate as seen by the fusion planner
+    struct Gate
+    {
+        using Matrix = Fusion::Matrix;
+        using IndexVector = Fusion::IndexVector;
+
+        Matrix matrix;
+        IndexVector targets;
+        IndexVector controls;
+    };
+
+    // Cost model used to decide whether two gates are worth fusing.
+    //
+    // All costs are expressed per amplitude of the state vector. A sweep over the state vector reads and writes one
+    // complex amplitude (2 x 16 bytes), while a dense kernel on k qubits performs 2^k complex multiply-adds (8 * 2^k
+    // flops) per amplitude. The machine balance (flops that can be executed for each byte transferred from memory)
+    // then gives the relative weight of both contributions.
+    struct CostModel
+    {
+        static constexpr auto bytes_per_sweep = 32.;
+        static constexpr auto flops_per_madd = 8.;
+
+        double flops_per_byte = 4.;
+
+        [[nodiscard]] double operator()(std::size_t num_qubits) const
+        {
+            if (num_qubits == 0) {
+                return 0.;
+            }
+            return 1. + flops_per_madd * static_cast<double>(1UL << num_qubits) / (bytes_per_sweep * flops_per_byte);
+        }
+    };
+
+    // Offline fusion pass: split a whole gate sequence into blocks of at most k qubits
+    //
+    // Contrary to the online fusion in Simulator::apply_controlled_gate() which only considers the gates in their
+    // order of arrival, the planner looks ahead in the gate sequence and is allowed to move a gate past other gates
+    // with which it commutes in order to add it to the current block.
+    class FusionPlanner
+    {
+    public:
+        using Index = Fusion::Index;
+        using IndexVector = Fusion::IndexVector;
+        using GateVector = std::vector<Gate>;
+        using BlockVector = std::vector<Fusion>;
+
+        static constexpr auto default_lookahead = 64U;
+
+        explicit FusionPlanner(unsigned max_qubits, CostModel cost = {}, unsigned lookahead = default_lookahead)
+            : max_qubits_(max_qubits), cost_(cost), lookahead_(lookahead)
+        {
+            if (max_qubits_ == 0) {
+                throw std::invalid_argument("FusionPlanner: the maximum number of qubits per block must be > 0!");
+            }
+        }
+
+        [[nodiscard]] unsigned max_qubits() const
+        {
+            return max_qubits_;
+        }
+
+        [[nodiscard]] BlockVector plan(GateVector const& gates) const
+        {
+            std::vector<Footprint> footprints;
+            footprints.reserve(gates.size());
+            for (auto const& gate: gates) {
+                footprints.emplace_back(gate);
+            }
+
+            std::vector<bool> scheduled(gates.size(), false);
+            BlockVector blocks;
+
+            for (std::size_t first = 0; first < gates.size(); ++first) {
+                if (scheduled[first]) {
+                    continue;
+                }
+
+                Fusion block;
+                block.insert(gates[first].matrix, gates[first].targets, gates[first].controls);
+                scheduled[first] = true;
+
+                // Gates that were skipped while building the current block. Any candidate gate needs to commute with
+                // all of those to be moved into the block.
+                std::vector<std::size_t> skipped;
+
+                auto budget = lookahead_;
+                for (auto idx = first + 1; idx < gates.size() && budget > 0; ++idx) {
+                    if (scheduled[idx]) {
+                        continue;
+                    }
+                    --budget;
+
+                    auto const& gate = gates[idx];
+                    const auto commutes = std::all_of(begin(skipped), end(skipped), [&](std::size_t other) {
+                        return footprints[idx].commutes_with(footprints[other]);
+                    });
+
+                    if (commutes && worth_fusing_(block, gate)) {
+                        block.insert(gate.matrix, gate.targets, gate.controls);
+                        scheduled[idx] = true;
+                    }
+                    else {
+                        skipped.push_back(idx);
+                    }
+                }
+
+                blocks.emplace_back(std::move(block));
+            }
+
+            return blocks;
+        }
+
+    private:
+        // Per-qubit action of a gate, used for the commutation checks
+        struct Footprint
+        {
+            explicit Footprint(Gate const& gate)
+            {
+                const auto diagonal = is_diagonal(gate.matrix);
+                for (auto id: gate.targets) {
+                    (diagonal ? diagonal_ : general_).push_back(id);
+                }
+                // Controls only act as projectors in the computational basis
+                diagonal_.insert(end(diagonal_), begin(gate.controls), end(gate.controls));
+            }
+
+            // Sufficient condition: on every shared qubit, both gates act diagonally
+            [[nodiscard]] bool commutes_with(Footprint const& other) const
+            {
+                return !intersects(general_, other.general_) && !intersects(general_, other.diagonal_)
+                       && !intersects(diagonal_, other.general_);
+            }
+
+            static bool is_diagonal(Gate::Matrix const& m)
+            {
+                auto dim = static_cast<std::size_t>(std::sqrt(m.size()));
+                for (std::size_t i = 0; i < dim; ++i) {
+                    for (std::size_t j = 0; j < dim; ++j) {
+                        if (i != j && m[i * dim + j] != Gate::Matrix::value_type{0.}) {
+                            return false;
+                        }
+                    }
+                }
+                return true;
+            }
+
+            static bool intersects(IndexVector const& a, IndexVector const& b)
+            {
+                return std::any_of(begin(a), end(a),
+                                   [&b](Index id) { return std::find(begin(b), end(b), id) != end(b); });
+            }
+
+            IndexVector diagonal_;
+            IndexVector general_;
+        };
+
+        [[nodiscard]] bool worth_fusing_(Fusion const& block, Gate const& gate) const
+        {
+            const auto fused_qubits = block.num_qubits_if_inserted(gate.targets, gate.controls);
+            if (fused_qubits > max_qubits_) {
+                return false;
+            }
+            // NB: applied on its own, the controls of a gate are handled by the control mask of the kernel
+            return cost_(fused_qubits) <= cost_(block.num_qubits()) + cost_(gate.targets.size());
+        }
+
+        unsigned max_qubits_;
+        CostModel cost_;
+        unsigned lookahead_;
+    };
+}  // namespace fusion
+
+#endif /* FUSION_PLANNER_HPP */
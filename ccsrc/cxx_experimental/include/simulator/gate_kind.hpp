@@ -0,0 +1,101 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef GATE_KIND_HPP
+#define GATE_KIND_HPP
+
+#include "fusion.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace fusion
+{
+    // Structure of a (fused) gate matrix
+    enum class GateKind
+    {
+        general,             // Dense matrix
+        diagonal,            // Diagonal matrix (e.g. Z, S, T, Rz, Rzz, CZ, P)
+        permutation,         // Permutation matrix (e.g. X, CNOT, SWAP)
+        phased_permutation,  // Permutation matrix with arbitrary non-zero entries (e.g. Y)
+    };
+
+    // Compact representation of a non-general gate
+    //
+    // For all kinds of gates, row i of the matrix has a single non-zero entry phases[i], located in column perm[i].
+    struct StructuredGate
+    {
+        static constexpr auto max_dim = 1U << 5U;
+
+        GateKind kind = GateKind::general;
+        unsigned dim = 0;
+        std::array<unsigned, max_dim> perm{};
+        std::array<Fusion::Complex, max_dim> phases{};
+    };
+
+    // Classify a square matrix given in row-major order
+    //
+    // NB: only exact zeros are considered, so that the result does not depend on any tolerance. Products of diagonal
+    //     (resp. permutation) matrices as computed by Fusion::perform_fusion() have exact zeros where expected.
+    inline StructuredGate classify(Fusion::Matrix const& m)
+    {
+        StructuredGate gate;
+        const auto dim = static_cast<std::size_t>(std::sqrt(m.size()));
+        if (dim > StructuredGate::max_dim) {
+            return gate;
+        }
+
+        const Fusion::Complex zero{0.};
+        const Fusion::Complex one{1.};
+        std::array<bool, StructuredGate::max_dim> used{};
+        auto is_diagonal = true;
+        auto is_permutation = true;
+
+        for (std::size_t i = 0; i < dim; ++i) {
+            auto found = false;
+            for (std::size_t j = 0; j < dim; ++j) {
+                const auto& el = m[i * dim + j];
+                if (el == zero) {
+                    continue;
+                }
+                if (found || used[j]) {
+                    return gate;
+                }
+                found = used[j] = true;
+                gate.perm[i] = static_cast<unsigned>(j);
+                gate.phases[i] = el;
+                is_diagonal &= (i == j);
+                is_permutation &= (el == one);
+            }
+            if (!found) {
+                return gate;
+            }
+        }
+
+        gate.dim = static_cast<unsigned>(dim);
+        if (is_diagonal) {
+            gate.kind = GateKind::diagonal;
+        }
+        else if (is_permutation) {
+            gate.kind = GateKind::permutation;
+        }
+        else {
+            gate.kind = GateKind::phased_permutation;
+        }
+        return gate;
+    }
+}  // namespace fusion
+
+#endif /* GATE_KIND_HPP */
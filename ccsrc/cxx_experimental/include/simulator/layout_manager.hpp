@@ -0,0 +1,175 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef LAYOUT_MANAGER_HPP
+#define LAYOUT_MANAGER_HPP
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace layout
+{
+    // Tracks which qubits are used as gate targets and periodically proposes to move the most frequently used ones
+    // into the low-order bits of the state vector (swap-to-low).
+    //
+    // Gates acting on high-order bits access the state vector with large strides, which is hard on the caches and the
+    // TLB. Every `period` gates, the qubits that are among the `low_qubits` most used ones but are located at or
+    // above bit `low_qubits` are swapped with the least used qubits located below that bit. The resulting bit
+    // permutation is only worth applying (one extra pass over the state vector) if it moves enough gates to the low
+    // bits, hence the `min_gain` threshold.
+    class LayoutManager
+    {
+    public:
+        using Map = std::map<unsigned, unsigned>;
+        using Permutation = std::vector<unsigned>;
+
+        static constexpr auto default_period = 64U;
+        static constexpr auto default_low_qubits = 10U;  // 16 KiB strides
+        static constexpr auto default_min_gain = 8U;
+
+        explicit LayoutManager(unsigned period = default_period, unsigned low_qubits = default_low_qubits,
+                               unsigned min_gain = default_min_gain)
+            : period_(period), low_qubits_(low_qubits), min_gain_(min_gain)
+        {
+            if (period_ == 0 || low_qubits_ == 0) {
+                throw std::invalid_argument("LayoutManager: period and number of low qubits must be > 0!");
+            }
+        }
+
+        // Record the (logical) target qubits of a gate
+        template <typename index_vector_t>
+        void record(index_vector_t const& ids)
+        {
+            for (auto id: ids) {
+                ++usage_[id];
+            }
+            ++num_gates_;
+        }
+
+        [[nodiscard]] bool due() const
+        {
+            return num_gates_ >= period_;
+        }
+
+        [[nodiscard]] std::size_t num_reorders() const
+        {
+            return num_reorders_;
+        }
+
+        // Compute the new layout given the current logical -> physical mapping
+        //
+        // Returns perm such that bit p of the state vector should be moved to bit perm[p], or an empty permutation if
+        // the layout should be kept. The usage statistics are reset in any case.
+        Permutation plan(Map const& map)
+        {
+            Permutation perm;
+            const auto num_qubits = static_cast<unsigned>(map.size());
+
+            if (num_qubits > low_qubits_) {
+                auto usage = [this](unsigned id) {
+                    auto it = usage_.find(id);
+                    return it == usage_.end() ? std::size_t(0) : it->second;
+                };
+
+                std::vector<std::pair<unsigned, unsigned>> qubits(begin(map), end(map));
+                // Most used first; on ties, prefer the qubits that are already low
+                std::stable_sort(begin(qubits), end(qubits), [&usage](auto const& lhs, auto const& rhs) {
+                    const auto ul = usage(lhs.first);
+                    const auto ur = usage(rhs.first);
+                    return ul != ur ? ul > ur : lhs.second < rhs.second;
+                });
+
+                std::vector<std::pair<unsigned, unsigned>> hot_high;
+                std::vector<std::pair<unsigned, unsigned>> cold_low;
+                for (std::size_t i = 0; i < qubits.size(); ++i) {
+                    const auto is_hot = i < low_qubits_ && usage(qubits[i].first) > 0;
+                    const auto is_low = qubits[i].second < low_qubits_;
+                    if (is_hot && !is_low) {
+                        hot_high.push_back(qubits[i]);
+                    }
+                    else if (!is_hot && is_low) {
+                        cold_low.push_back(qubits[i]);
+                    }
+                }
+                // Least used first
+                std::reverse(begin(cold_low), end(cold_low));
+
+                const auto num_swaps = std::min(hot_high.size(), cold_low.size());
+                std::size_t gain = 0;
+                for (std::size_t k = 0; k < num_swaps; ++k) {
+                    gain += usage(hot_high[k].first) - usage(cold_low[k].first);
+                }
+
+                if (num_swaps > 0 && gain >= min_gain_) {
+                    perm.resize(num_qubits);
+                    for (unsigned p = 0; p < num_qubits; ++p) {
+                        perm[p] = p;
+                    }
+                    for (std::size_t k = 0; k < num_swaps; ++k) {
+                        std::swap(perm[hot_high[k].second], perm[cold_low[k].second]);
+                    }
+                    ++num_reorders_;
+                }
+            }
+
+            usage_.clear();
+            num_gates_ = 0;
+            return perm;
+        }
+
+        // Move bit p of every index of src to bit perm[p] in dst (dst must have the same size as src)
+        template <class V>
+        static void permute(V const& src, V& dst, Permutation const& perm)
+        {
+            // Lookup tables mapping each byte of the source index to its bits in the destination index
+            constexpr auto byte_values = 1U << CHAR_BIT;
+            const auto num_bytes = (perm.size() + CHAR_BIT - 1) / CHAR_BIT;
+            std::vector<std::array<std::size_t, byte_values>> tables(num_bytes);
+            for (std::size_t b = 0; b < num_bytes; ++b) {
+                for (std::size_t v = 0; v < byte_values; ++v) {
+                    std::size_t idx = 0;
+                    for (std::size_t k = 0; k < CHAR_BIT && b * CHAR_BIT + k < perm.size(); ++k) {
+                        idx |= ((v >> k) & 1U) << perm[b * CHAR_BIT + k];
+                    }
+                    tables[b][v] = idx;
+                }
+            }
+
+            const auto* tab = tables.data();
+#pragma omp parallel for schedule(static)
+            for (std::size_t i = 0; i < src.size(); ++i) {
+                std::size_t j = 0;
+                for (std::size_t b = 0; b < num_bytes; ++b) {
+                    j |= tab[b][(i >> (b * CHAR_BIT)) & (byte_values - 1U)];
+                }
+                dst[j] = src[i];
+            }
+        }
+
+    private:
+        unsigned period_;
+        unsigned low_qubits_;
+        unsigned min_gain_;
+        std::map<unsigned, std::size_t> usage_;
+        unsigned num_gates_ = 0;
+        std::size_t num_reorders_ = 0;
+    };
+}  // namespace layout
+
+#endif /* LAYOUT_MANAGER_HPP */
@@ -0,0 +1,216 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef PAULI_EXPECTATION_HPP
+#define PAULI_EXPECTATION_HPP
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace pauli
+{
+    // Pauli string in terms of bit masks over the (physical) qubits of the state vector, similar to mq_base's
+    // PauliMask. The operator is i^phase * prod_{k in x} X_k * prod_{k in y} Y_k * prod_{k in z} Z_k.
+    struct PauliMask
+    {
+        std::size_t mask_x = 0;
+        std::size_t mask_y = 0;
+        std::size_t mask_z = 0;
+        unsigned num_y = 0;
+        unsigned phase = 0;
+
+        // Qubits whose value is flipped by the operator
+        [[nodiscard]] std::size_t flip_mask() const
+        {
+            return mask_x | mask_y;
+        }
+        // Qubits contributing a sign (-1)^bit: Z and Y (Y|b> = i (-1)^b |1-b>)
+        [[nodiscard]] std::size_t sign_mask() const
+        {
+            return mask_y | mask_z;
+        }
+    };
+
+    namespace details
+    {
+        enum PauliOp : unsigned
+        {
+            I = 0,
+            X = 1,
+            Y = 2,
+            Z = 3,
+        };
+
+        // Product b * a of two single-qubit Pauli operators: returns the resulting operator and the power of i of the
+        // phase (e.g. X * Y = i Z)
+        inline std::pair<unsigned, unsigned> multiply(unsigned b, unsigned a)
+        {
+            if (a == I || b == I) {
+                return {a ^ b, 0U};
+            }
+            if (a == b) {
+                return {I, 0U};
+            }
+            const auto c = 6U - a - b;
+            // Cyclic order X -> Y -> Z -> X gives +i, anti-cyclic order -i
+            const auto cyclic = (b % 3U) + 1U == a;
+            return {c, cyclic ? 1U : 3U};
+        }
+    }  // namespace details
+
+    //! Build the masks of a Pauli string given as a list of (qubit, 'X'|'Y'|'Z') pairs
+    /*!
+     * \param position Converts the qubit of each pair into a bit position in the state vector
+     *
+     * The operators are applied in the order of the list (i.e. the last one is the left-most factor); repeated qubits
+     * are allowed.
+     */
+    template <typename term_t, typename func_t>
+    PauliMask make_pauli_mask(term_t const& term, func_t&& position)
+    {
+        std::map<std::size_t, unsigned> ops;
+        unsigned phase = 0;
+        for (auto const& [qubit, op]: term) {
+            if (op != 'X' && op != 'Y' && op != 'Z') {
+                throw std::invalid_argument("make_pauli_mask(): invalid Pauli operator!");
+            }
+            auto& current = ops[position(qubit)];
+            const auto [res, power] = details::multiply(static_cast<unsigned>(op - 'X') + 1U, current);
+            current = res;
+            phase += power;
+        }
+
+        PauliMask mask;
+        for (auto const& [pos, op]: ops) {
+            const auto bit = std::size_t(1) << pos;
+            if (op == details::X) {
+                mask.mask_x |= bit;
+            }
+            else if (op == details::Y) {
+                mask.mask_y |= bit;
+                ++mask.num_y;
+            }
+            else if (op == details::Z) {
+                mask.mask_z |= bit;
+            }
+        }
+        mask.phase = phase % 4U;
+        return mask;
+    }
+
+    //! Compute <psi|P|psi> for a batch of Pauli strings in a single read-only pass over the state vector
+    /*!
+     * With flip = x | y, sign(i) = (-1)^popcount(i & (y | z)) and j = i ^ flip:
+     *     <psi|P|psi> = i^(num_y + phase) * sum_i sign(i) * conj(psi[j]) * psi[i]
+     * Only the real part is returned (the full value for Hermitian operators). If flip != 0, the amplitudes i and j
+     * are processed together, so that only half the indices are enumerated.
+     *
+     * Terms sharing the same flip mask (very common in molecular Hamiltonians) share the computation of
+     * conj(psi[j]) * psi[i]. The state vector is processed tile by tile and all the terms are evaluated on a tile
+     * before moving to the next one.
+     */
+    template <class V>
+    std::vector<double> expectation_values(V const& psi, std::vector<PauliMask> const& masks)
+    {
+        constexpr std::size_t tile_size = 1UL << 12U;
+        constexpr std::size_t max_parts = 256;
+
+        struct Term
+        {
+            std::size_t index;
+            std::size_t sign_mask;
+            double re;  // val = re * Re(a) + im * Im(a)
+            double im;
+        };
+        struct Group
+        {
+            std::size_t flip;
+            std::vector<Term> terms;
+        };
+
+        // Group the terms by flip mask
+        std::map<std::size_t, std::vector<Term>> by_flip;
+        for (std::size_t t = 0; t < masks.size(); ++t) {
+            // With a = conj(psi[j]) * psi[i], the pair (i, j) contributes Re(i^k * sign(i) * (a + (-1)^num_y conj(a)))
+            // i.e. 2 Re(i^k) Re(a) if num_y is even and -2 Im(i^k) Im(a) otherwise
+            constexpr double re_pow[] = {1., 0., -1., 0.};
+            constexpr double im_pow[] = {0., 1., 0., -1.};
+            const auto k = (masks[t].num_y + masks[t].phase) % 4U;
+            const auto odd = masks[t].num_y % 2U != 0U;
+            by_flip[masks[t].flip_mask()].push_back(
+                {t, masks[t].sign_mask(), odd ? 0. : re_pow[k], odd ? -im_pow[k] : 0.});
+        }
+        std::vector<Group> groups;
+        groups.reserve(by_flip.size());
+        for (auto& [flip, terms]: by_flip) {
+            groups.push_back({flip, std::move(terms)});
+        }
+
+        const auto size = static_cast<std::size_t>(psi.size());
+        const auto num_terms = masks.size();
+        const auto num_tiles = (size + tile_size - 1) / tile_size;
+        const auto num_parts = std::max<std::size_t>(1, std::min(num_tiles, max_parts));
+        const auto tiles_per_part = (num_tiles + num_parts - 1) / num_parts;
+
+        // Partial sums per part of the state vector (avoids array reductions)
+        std::vector<double> partial(num_parts * num_terms, 0.);
+
+#pragma omp parallel for schedule(dynamic, 1)
+        for (std::size_t part = 0; part < num_parts; ++part) {
+            auto* res = &partial[part * num_terms];
+            const auto tile_end = std::min(num_tiles, (part + 1) * tiles_per_part);
+            for (std::size_t tile = part * tiles_per_part; tile < tile_end; ++tile) {
+                const auto begin = tile * tile_size;
+                const auto end = std::min(size, begin + tile_size);
+                for (auto const& group: groups) {
+                    const auto flip = group.flip;
+                    const auto pivot = flip & (~flip + 1U);  // lowest flipped bit
+                    const auto factor = flip == 0 ? 1. : 2.;
+
+                    // Only the indices with a 0 at the position of the pivot
+                    if (pivot >= tile_size && (begin & pivot) != 0) {
+                        continue;
+                    }
+                    const auto step = pivot >= tile_size || pivot == 0 ? end - begin : pivot;
+                    for (std::size_t i0 = begin; i0 < end; i0 += 2 * step) {
+                        const auto i1 = std::min(end, i0 + step);
+                        for (std::size_t i = i0; i < i1; ++i) {
+                            const std::complex<double> a = std::conj(std::complex<double>(psi[i ^ flip]))
+                                                           * std::complex<double>(psi[i]);
+                            for (auto const& term: group.terms) {
+                                const auto val = factor * (term.re * a.real() + term.im * a.imag());
+                                res[term.index] += __builtin_parityll(i & term.sign_mask) != 0 ? -val : val;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        std::vector<double> values(num_terms, 0.);
+        for (std::size_t part = 0; part < num_parts; ++part) {
+            for (std::size_t t = 0; t < num_terms; ++t) {
+                values[t] += partial[part * num_terms + t];
+            }
+        }
+        return values;
+    }
+}  // namespace pauli
+
+#endif /* PAULI_EXPECTATION_HPP */
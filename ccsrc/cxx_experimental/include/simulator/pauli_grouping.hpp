@@ -0,0 +1,312 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef PAULI_GROUPING_HPP
+#define PAULI_GROUPING_HPP
+
+#include "pauli_expectation.hpp"
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+namespace pauli
+{
+    // Set of qubit-wise commuting Pauli strings: on every qubit, all the terms of the group act either trivially or
+    // with the same Pauli operator (the basis of the group). All the terms become diagonal after rotating each qubit
+    // of mask_x (resp. mask_y) from the X (resp. Y) basis into the Z basis.
+    struct PauliGroup
+    {
+        std::vector<std::size_t> terms;
+        std::size_t mask_x = 0;
+        std::size_t mask_y = 0;
+        std::size_t mask_z = 0;
+
+        [[nodiscard]] bool diagonal() const
+        {
+            return (mask_x | mask_y) == 0;
+        }
+    };
+
+    // Partition of a list of Pauli strings into groups. Only depends on the terms so it can be computed once and
+    // reused for every evaluation of the same Hamiltonian (e.g. across the iterations of a variational algorithm).
+    struct PauliGrouping
+    {
+        std::vector<PauliMask> masks;
+        std::vector<PauliGroup> groups;
+    };
+
+    //! Greedy (largest terms first) partition into qubit-wise commuting groups
+    inline PauliGrouping group_qubit_wise(std::vector<PauliMask> const& masks)
+    {
+        auto weight = [&masks](std::size_t t) {
+            return __builtin_popcountll(masks[t].mask_x | masks[t].mask_y | masks[t].mask_z);
+        };
+
+        std::vector<std::size_t> order(masks.size());
+        std::iota(begin(order), end(order), 0UL);
+        std::stable_sort(begin(order), end(order), [&weight](auto lhs, auto rhs) { return weight(lhs) > weight(rhs); });
+
+        PauliGrouping grouping;
+        grouping.masks = masks;
+        for (auto t: order) {
+            const auto& mask = masks[t];
+            auto compatible = [&mask](PauliGroup const& group) {
+                return ((mask.mask_x & (group.mask_y | group.mask_z)) | (mask.mask_y & (group.mask_x | group.mask_z))
+                        | (mask.mask_z & (group.mask_x | group.mask_y)))
+                       == 0;
+            };
+            auto it = std::find_if(begin(grouping.groups), end(grouping.groups), compatible);
+            if (it == end(grouping.groups)) {
+                it = grouping.groups.emplace(end(grouping.groups));
+            }
+            it->terms.push_back(t);
+            it->mask_x |= mask.mask_x;
+            it->mask_y |= mask.mask_y;
+            it->mask_z |= mask.mask_z;
+        }
+        return grouping;
+    }
+
+    //! Move bit p of all the masks of a grouping to bit position(p)
+    template <typename func_t>
+    PauliGrouping remap(PauliGrouping const& grouping, func_t&& position)
+    {
+        auto remap_bits = [&position](std::size_t mask) {
+            std::size_t res = 0;
+            for (unsigned p = 0; mask != 0; ++p, mask >>= 1U) {
+                if ((mask & 1U) != 0) {
+                    res |= std::size_t(1) << position(p);
+                }
+            }
+            return res;
+        };
+
+        PauliGrouping res = grouping;
+        for (auto& mask: res.masks) {
+            mask.mask_x = remap_bits(mask.mask_x);
+            mask.mask_y = remap_bits(mask.mask_y);
+            mask.mask_z = remap_bits(mask.mask_z);
+        }
+        for (auto& group: res.groups) {
+            group.mask_x = remap_bits(group.mask_x);
+            group.mask_y = remap_bits(group.mask_y);
+            group.mask_z = remap_bits(group.mask_z);
+        }
+        return res;
+    }
+
+    namespace details
+    {
+        // Largest number of qubits for which the diagonal sweep accumulates a marginal histogram
+        static constexpr auto histogram_qubits = 10U;
+        static constexpr std::size_t histogram_parts = 64;
+
+        // Largest number of qubits rotated into the Z basis by a single pass over the state vector
+        static constexpr auto max_rotation_qubits = 5U;
+
+        // Rotate the qubits qubits[0..n) (sorted in increasing order, n <= max_rotation_qubits) from the X basis (H) or
+        // the Y basis (H S^dagger, if the qubit is set in mask_y) into the Z basis: dst = (U_1 x ... x U_n) src
+        //
+        // The 2^n amplitudes that only differ in the rotated qubits are loaded together, transformed by one butterfly
+        // per qubit and stored, so each amplitude is read and written once. src and dst may be the same vector.
+        template <class V>
+        void rotate_to_z(V const& src, V& dst, const unsigned* qubits, unsigned n, std::size_t mask_y)
+        {
+            constexpr auto max_dim = 1U << max_rotation_qubits;
+            const auto dim = 1U << n;
+            std::array<std::size_t, max_dim> offsets{};
+            for (unsigned j = 0; j < dim; ++j) {
+                for (unsigned l = 0; l < n; ++l) {
+                    if (((j >> l) & 1U) != 0) {
+                        offsets[j] |= std::size_t(1) << qubits[l];
+                    }
+                }
+            }
+            const auto scale = std::pow(M_SQRT1_2, static_cast<double>(n));
+
+            const auto ngroups = static_cast<std::size_t>(src.size()) >> n;
+#pragma omp parallel for schedule(static)
+            for (std::size_t g = 0; g < ngroups; ++g) {
+                auto base = g;
+                for (unsigned l = 0; l < n; ++l) {
+                    const auto low = (std::size_t(1) << qubits[l]) - 1U;
+                    base = ((base & ~low) << 1U) | (base & low);
+                }
+
+                std::array<std::complex<double>, max_dim> v;
+                for (unsigned j = 0; j < dim; ++j) {
+                    v[j] = src[base | offsets[j]];
+                }
+                for (unsigned l = 0; l < n; ++l) {
+                    const auto bit = 1U << l;
+                    const auto y_basis = ((mask_y >> qubits[l]) & 1U) != 0;
+                    for (unsigned j = 0; j < dim; ++j) {
+                        if ((j & bit) == 0) {
+                            const auto a = v[j];
+                            auto b = v[j | bit];
+                            if (y_basis) {
+                                b = {b.imag(), -b.real()};  // -i b
+                            }
+                            v[j] = a + b;
+                            v[j | bit] = a - b;
+                        }
+                    }
+                }
+                for (unsigned j = 0; j < dim; ++j) {
+                    dst[base | offsets[j]] = scale * v[j];
+                }
+            }
+        }
+
+        // Value of Re(<phi|Z_m|phi>) for every term of a group, for a state in which all terms are diagonal
+        template <class V>
+        void diagonal_sweep(V const& phi, PauliGrouping const& grouping, PauliGroup const& group,
+                            std::vector<double>& values)
+        {
+            const auto support = group.mask_x | group.mask_y | group.mask_z;
+            const auto nbits = static_cast<unsigned>(__builtin_popcountll(support));
+
+            // Real part of the global phase of each term
+            auto phase_factor = [](PauliMask const& mask) {
+                constexpr double re_pow[] = {1., 0., -1., 0.};
+                return re_pow[mask.phase % 4U];
+            };
+
+            if (nbits > histogram_qubits) {
+                std::vector<PauliMask> zmasks;
+                zmasks.reserve(group.terms.size());
+                for (auto t: group.terms) {
+                    const auto& mask = grouping.masks[t];
+                    PauliMask z;
+                    z.mask_z = mask.mask_x | mask.mask_y | mask.mask_z;
+                    z.phase = mask.phase;
+                    zmasks.push_back(z);
+                }
+                const auto res = expectation_values(phi, zmasks);
+                for (std::size_t k = 0; k < group.terms.size(); ++k) {
+                    values[group.terms[k]] = res[k];
+                }
+                return;
+            }
+
+            // Lookup tables compressing each byte of an index onto the support bits
+            constexpr auto byte_values = 1U << CHAR_BIT;
+            const auto num_bytes = sizeof(std::size_t);
+            std::vector<std::array<std::size_t, byte_values>> tables(num_bytes);
+            std::vector<std::size_t> bytes;
+            unsigned offset = 0;
+            for (std::size_t b = 0; b < num_bytes; ++b) {
+                const auto sub = (support >> (b * CHAR_BIT)) & (byte_values - 1U);
+                if (sub == 0) {
+                    continue;
+                }
+                bytes.push_back(b);
+                for (std::size_t v = 0; v < byte_values; ++v) {
+                    std::size_t idx = 0;
+                    unsigned pos = offset;
+                    for (unsigned k = 0; k < CHAR_BIT; ++k) {
+                        if (((sub >> k) & 1U) != 0) {
+                            idx |= ((v >> k) & 1U) << pos++;
+                        }
+                    }
+                    tables[b][v] = idx;
+                }
+                offset += static_cast<unsigned>(__builtin_popcountll(sub));
+            }
+            auto compress = [&](std::size_t i) {
+                std::size_t idx = 0;
+                for (auto b: bytes) {
+                    idx |= tables[b][(i >> (b * CHAR_BIT)) & (byte_values - 1U)];
+                }
+                return idx;
+            };
+
+            // Marginal probabilities of the support qubits (one histogram per part to avoid array reductions)
+            const auto hist_size = std::size_t(1) << nbits;
+            const auto size = static_cast<std::size_t>(phi.size());
+            const auto num_parts = std::min(histogram_parts, size);
+            const auto part_size = (size + num_parts - 1) / num_parts;
+            std::vector<double> hist(num_parts * hist_size, 0.);
+#pragma omp parallel for schedule(static)
+            for (std::size_t part = 0; part < num_parts; ++part) {
+                auto* h = &hist[part * hist_size];
+                const auto end = std::min(size, (part + 1) * part_size);
+                for (std::size_t i = part * part_size; i < end; ++i) {
+                    h[compress(i)] += std::norm(std::complex<double>(phi[i]));
+                }
+            }
+            for (std::size_t part = 1; part < num_parts; ++part) {
+                for (std::size_t c = 0; c < hist_size; ++c) {
+                    hist[c] += hist[part * hist_size + c];
+                }
+            }
+
+            for (auto t: group.terms) {
+                const auto& mask = grouping.masks[t];
+                const auto zmask = compress(mask.mask_x | mask.mask_y | mask.mask_z);
+                double value = 0.;
+                for (std::size_t c = 0; c < hist_size; ++c) {
+                    value += __builtin_parityll(c & zmask) != 0 ? -hist[c] : hist[c];
+                }
+                values[t] = phase_factor(mask) * value;
+            }
+        }
+    }  // namespace details
+
+    //! Compute Re(<psi|P|psi>) for all the terms of a grouping
+    /*!
+     * The diagonal group is evaluated with a single sweep over psi. For every other group, the shared basis change
+     * is applied on a copy of the state stored in workspace (resized if needed), followed by one diagonal sweep. The
+     * basis change rotates up to details::max_rotation_qubits qubits per pass over the state vector.
+     * The diagonal sweeps accumulate the marginal probabilities of the qubits of the group, so that their cost does
+     * not depend on the number of terms in the group.
+     */
+    template <class V>
+    std::vector<double> grouped_expectation_values(V const& psi, PauliGrouping const& grouping, V& workspace)
+    {
+        std::vector<double> values(grouping.masks.size(), 0.);
+        for (auto const& group: grouping.groups) {
+            if (group.diagonal()) {
+                details::diagonal_sweep(psi, grouping, group, values);
+                continue;
+            }
+
+            std::vector<unsigned> qubits;
+            const auto rotated = group.mask_x | group.mask_y;
+            for (unsigned q = 0; (std::size_t(1) << q) <= rotated; ++q) {
+                if (((rotated >> q) & 1U) != 0) {
+                    qubits.push_back(q);
+                }
+            }
+
+            workspace.resize(psi.size());
+            const V* src = &psi;
+            for (std::size_t first = 0; first < qubits.size(); first += details::max_rotation_qubits) {
+                const auto n = std::min<std::size_t>(details::max_rotation_qubits, qubits.size() - first);
+                details::rotate_to_z(*src, workspace, &qubits[first], static_cast<unsigned>(n), group.mask_y);
+                src = &workspace;
+            }
+            details::diagonal_sweep(workspace, grouping, group, values);
+        }
+        return values;
+    }
+}  // namespace pauli
+
+#endif /* PAULI_GROUPING_HPP */
@@ -0,0 +1,211 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef PAULI_SUM_HPP
+#define PAULI_SUM_HPP
+
+#include "pauli_expectation.hpp"
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace pauli
+{
+    // Linear combination of Pauli strings compiled into flat arrays, built once and reused for every application
+    //
+    // Term t is coeffs[t] * i^phases[t] * P_t, with P_t described by x_masks[t] (qubits flipped, i.e. X or Y) and
+    // z_masks[t] (qubits contributing a sign, i.e. Y or Z):
+    //     (P_t psi)[i] = (-1)^popcount((i ^ x) & z) * psi[i ^ x]
+    // The terms are sorted by x mask so that the terms sharing the same x mask are contiguous (group g contains the
+    // terms group_offsets[g] to group_offsets[g + 1] - 1).
+    class CompiledPauliSum
+    {
+    public:
+        CompiledPauliSum() = default;
+
+        //! Compile a list of (term, coefficient) pairs, terms being lists of (qubit, 'X'|'Y'|'Z') pairs
+        /*!
+         * \param position Converts the qubit of each pair into a bit position in the state vector
+         */
+        template <typename terms_t, typename func_t>
+        CompiledPauliSum(terms_t const& terms, func_t&& position)
+        {
+            std::vector<PauliMask> masks;
+            std::vector<std::complex<double>> coeffs;
+            for (auto const& [term, coeff]: terms) {
+                masks.push_back(make_pauli_mask(term, position));
+                coeffs.emplace_back(coeff);
+            }
+
+            std::vector<std::size_t> order(masks.size());
+            std::iota(begin(order), end(order), 0UL);
+            std::stable_sort(begin(order), end(order), [&masks](auto lhs, auto rhs) {
+                return masks[lhs].flip_mask() < masks[rhs].flip_mask();
+            });
+
+            for (auto t: order) {
+                const auto& mask = masks[t];
+                if (!x_masks_.empty() && x_masks_.back() != mask.flip_mask()) {
+                    group_offsets_.push_back(x_masks_.size());
+                }
+                x_masks_.push_back(mask.flip_mask());
+                z_masks_.push_back(mask.sign_mask());
+                phases_.push_back(static_cast<uint8_t>((mask.num_y + mask.phase) % 4U));
+                coeffs_.push_back(coeffs[t]);
+            }
+            if (!x_masks_.empty()) {
+                group_offsets_.push_back(x_masks_.size());
+            }
+            update_weights();
+        }
+
+        [[nodiscard]] std::size_t size() const
+        {
+            return coeffs_.size();
+        }
+        [[nodiscard]] std::size_t num_groups() const
+        {
+            return group_offsets_.size() - 1;
+        }
+        [[nodiscard]] std::vector<std::size_t> const& x_masks() const
+        {
+            return x_masks_;
+        }
+        [[nodiscard]] std::vector<std::size_t> const& z_masks() const
+        {
+            return z_masks_;
+        }
+        [[nodiscard]] std::vector<uint8_t> const& phases() const
+        {
+            return phases_;
+        }
+        [[nodiscard]] std::vector<std::complex<double>> const& coeffs() const
+        {
+            return coeffs_;
+        }
+        [[nodiscard]] std::vector<std::size_t> const& group_offsets() const
+        {
+            return group_offsets_;
+        }
+
+        //! Upper bound on the spectral radius of the operator (sum of the absolute values of the coefficients)
+        [[nodiscard]] double radius() const
+        {
+            return std::accumulate(begin(coeffs_), end(coeffs_), 0.,
+                                   [](double sum, auto const& coeff) { return sum + std::abs(coeff); });
+        }
+
+        //! Combined coefficient of the terms of group g for the amplitude psi[j] (j = i ^ group_x_mask(g))
+        [[nodiscard]] std::complex<double> group_coeff(std::size_t g, std::size_t j) const
+        {
+            std::complex<double> c = 0.;
+            for (auto t = group_offsets_[g]; t < group_offsets_[g + 1]; ++t) {
+                c += __builtin_parityll(j & z_masks_[t]) != 0 ? -weights_[t] : weights_[t];
+            }
+            return c;
+        }
+
+        //! x mask shared by the terms of group g
+        [[nodiscard]] std::size_t group_x_mask(std::size_t g) const
+        {
+            return x_masks_[group_offsets_[g]];
+        }
+
+        //! Return a copy of the operator with bit p of all the masks moved to bit position(p)
+        template <typename func_t>
+        [[nodiscard]] CompiledPauliSum remapped(func_t&& position) const
+        {
+            auto remap_bits = [&position](std::size_t mask) {
+                std::size_t res = 0;
+                for (unsigned p = 0; mask != 0; ++p, mask >>= 1U) {
+                    if ((mask & 1U) != 0) {
+                        res |= std::size_t(1) << position(p);
+                    }
+                }
+                return res;
+            };
+
+            // NB: moving bits around does not change which terms share the same x mask
+            auto res = *this;
+            std::transform(begin(x_masks_), end(x_masks_), begin(res.x_masks_), remap_bits);
+            std::transform(begin(z_masks_), end(z_masks_), begin(res.z_masks_), remap_bits);
+            return res;
+        }
+
+        //! Compute dst = H src in a single pass, each amplitude of dst being written exactly once
+        /*!
+         * Only the amplitudes i with (i & ctrlmask) == ctrlmask are computed, the others are set to 0 (i.e. the
+         * operator is projected onto the control subspace).
+         *
+         * \note src and dst must not alias
+         */
+        template <class V>
+        void apply(V const& src, V& dst, std::size_t ctrlmask = 0) const
+        {
+            using value_t = typename V::value_type;
+            dst.resize(src.size());
+#pragma omp parallel for schedule(static)
+            for (std::size_t i = 0; i < src.size(); ++i) {
+                dst[i] = (i & ctrlmask) == ctrlmask ? value_t(row(src, i)) : value_t(0.);
+            }
+        }
+
+        //! Compute Re(<psi|H|psi>) in a single read-only pass, without storing H|psi>
+        template <class V>
+        [[nodiscard]] double expectation(V const& psi) const
+        {
+            double res = 0.;
+#pragma omp parallel for reduction(+ : res) schedule(static)
+            for (std::size_t i = 0; i < psi.size(); ++i) {
+                res += std::real(std::conj(std::complex<double>(psi[i])) * row(psi, i));
+            }
+            return res;
+        }
+
+    private:
+        void update_weights()
+        {
+            constexpr std::complex<double> i_pow[] = {{1., 0.}, {0., 1.}, {-1., 0.}, {0., -1.}};
+            weights_.resize(coeffs_.size());
+            for (std::size_t t = 0; t < coeffs_.size(); ++t) {
+                weights_[t] = coeffs_[t] * i_pow[phases_[t]];
+            }
+        }
+
+        // (H psi)[i]: a single load of psi[i ^ x] per group of terms
+        template <class V>
+        std::complex<double> row(V const& psi, std::size_t i) const
+        {
+            std::complex<double> acc = 0.;
+            for (std::size_t g = 0; g + 1 < group_offsets_.size(); ++g) {
+                const auto j = i ^ group_x_mask(g);
+                acc += group_coeff(g, j) * std::complex<double>(psi[j]);
+            }
+            return acc;
+        }
+
+        std::vector<std::size_t> x_masks_;
+        std::vector<std::size_t> z_masks_;
+        std::vector<uint8_t> phases_;  // power of i
+        std::vector<std::complex<double>> coeffs_;
+        std::vector<std::complex<double>> weights_;  // coeffs * i^phases
+        std::vector<std::size_t> group_offsets_{0};
+    };
+}  // namespace pauli
+
+#endif /* PAULI_SUM_HPP */
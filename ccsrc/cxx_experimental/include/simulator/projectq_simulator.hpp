@@ -16,6 +16,11 @@
 #define PROJECTQ_SIMULATOR_HPP
 
 #include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <utility>
+#include <variant>
+#include <vector>
 
 #include "simulator/config.hpp"
 
@@ -26,11 +31,26 @@
 namespace mindquantum::simulation::projectq {
 class Simulator : public BaseSimulator<Simulator> {
  public:
+    //! Floating point precision of the amplitudes of the state vector
+    enum class precision_t { fp64, fp32 };
+
     //! Simple constructor
     /*!
      * \param seed Seed for random generator.
+     * \param precision Precision of the state vector (::Simulator for fp64, ::SimulatorFloat for fp32)
      */
-    Simulator(uint32_t seed = 0);
+    Simulator(uint32_t seed = 0, precision_t precision = precision_t::fp64);
+
+    //! Return the precision of the state vector
+    MQ_NODISCARD precision_t precision() const {
+        return std::holds_alternative<::SimulatorFloat>(sim_) ? precision_t::fp32 : precision_t::fp64;
+    }
+
+    //! Call a function with the underlying simulator (either a ::Simulator or a ::SimulatorFloat)
+    template <typename func_t>
+    decltype(auto) visit(func_t&& func) {
+        return std::visit(std::forward<func_t>(func), sim_);
+    }
 
     //! Check whether a qubit is already allocated by the simulator
     /*!
@@ -51,12 +71,12 @@ class Simulator : public BaseSimulator<Simulator> {
      */
     MQ_NODISCARD bool run_instruction(const instruction_t& inst);
 
-    MQ_NODISCARD auto is_classical(const qubit_t& qubit, double tol = 1.e-12) {
-        return sim_.is_classical(qubit_id_t{qubit}, tol);
+    MQ_NODISCARD bool is_classical(const qubit_t& qubit, double tol = 1.e-12) {
+        return visit([&qubit, tol](auto& sim) { return sim.is_classical(qubit_id_t{qubit}, tol); });
     }
 
-    MQ_NODISCARD auto get_classical_value(const qubit_t& qubit, double tol = 1.e-12) {
-        return sim_.get_classical_value(qubit_id_t{qubit}, tol);
+    MQ_NODISCARD bool get_classical_value(const qubit_t& qubit, double tol = 1.e-12) {
+        return visit([&qubit, tol](auto& sim) { return sim.get_classical_value(qubit_id_t{qubit}, tol); });
     }
 
     MQ_NODISCARD auto measure_qubits_return(const qubits_t& qubits) {
@@ -65,16 +85,21 @@ class Simulator : public BaseSimulator<Simulator> {
                       [&targets](const auto& qubit) { targets.emplace_back(qubit_id_t{qubit}); });
     }
 
-    MQ_NODISCARD auto cheat() {
-        return sim_.cheat();
+    // NB: cheat() and pin_state() return precision dependent types, use visit() to access them
+
+    //! Set the state vector from an external buffer of amplitudes (converted to the precision of the simulator)
+    template <typename T>
+    void set_wavefunction(const std::complex<T>* wavefunction, std::size_t size,
+                          const std::vector<unsigned>& ordering) {
+        visit([&](auto& sim) { sim.set_wavefunction(wavefunction, size, ordering); });
     }
 
-    MQ_NODISCARD auto run() {
-        return sim_.run();
+    void run() {
+        visit([](auto& sim) { sim.run(); });
     }
 
  private:
-    ::projectq::Simulator sim_;
+    std::variant<::Simulator, ::SimulatorFloat> sim_;
 };
 }  // namespace mindquantum::simulation::projectq
 
@@ -0,0 +1,311 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef SAMPLING_HPP
+#define SAMPLING_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace sampling
+{
+    static constexpr std::size_t chunk_size = 1UL << 14U;
+
+    // Throw if a qubit position is out of range for a state vector of the given size
+    inline void check_positions(std::size_t size, std::vector<unsigned> const& positions)
+    {
+        for (auto pos: positions) {
+            if ((std::size_t(1) << pos) >= size) {
+                throw std::invalid_argument("Sampler: qubit position out of range!");
+            }
+        }
+    }
+
+    // Bit k of the result is the bit of idx located at positions[k]
+    inline std::size_t extract_bits(std::size_t idx, std::vector<unsigned> const& positions)
+    {
+        std::size_t res = 0;
+        for (std::size_t k = 0; k < positions.size(); ++k) {
+            res |= ((idx >> positions[k]) & 1U) << k;
+        }
+        return res;
+    }
+
+    // Draw a single outcome (u being a uniform variate in [0, 1)) without building any probability table
+    //
+    // An amplitude is picked with probability |psi[i]|^2 and the outcome is made of its bits at the measured positions.
+    // The norms of the chunks of the state vector are computed in parallel, then the chunk and the amplitude within
+    // that chunk are located by a serial search: only one value per chunk is stored. Amplitudes with a zero
+    // probability are never picked.
+    template <class V>
+    std::size_t sample_once(V const& psi, std::vector<unsigned> const& positions, double u)
+    {
+        const auto size = psi.size();
+        check_positions(size, positions);
+
+        const auto num_chunks = (size + chunk_size - 1) / chunk_size;
+        std::vector<double> sums(num_chunks, 0.);
+#pragma omp parallel for schedule(static)
+        for (std::size_t c = 0; c < num_chunks; ++c) {
+            const auto end = std::min(size, (c + 1) * chunk_size);
+            double sum = 0.;
+            for (std::size_t i = c * chunk_size; i < end; ++i) {
+                sum += std::norm(psi[i]);
+            }
+            sums[c] = sum;
+        }
+
+        double total = 0.;
+        std::size_t last = 0;  // last chunk with a non-zero probability
+        for (std::size_t c = 0; c < num_chunks; ++c) {
+            total += sums[c];
+            if (sums[c] > 0.) {
+                last = c;
+            }
+        }
+        if (!(total > 0.)) {
+            throw std::invalid_argument("Sampler: the state vector has a zero norm!");
+        }
+
+        auto x = u * total;
+        std::size_t c = 0;
+        for (; c < last && x >= sums[c]; ++c) {
+            x -= sums[c];
+        }
+
+        const auto end = std::min(size, (c + 1) * chunk_size);
+        std::size_t idx = c * chunk_size;
+        for (std::size_t i = c * chunk_size; i < end; ++i) {
+            const auto p = std::norm(psi[i]);
+            if (p > 0.) {
+                idx = i;
+                if (x < p) {
+                    break;
+                }
+                x -= p;
+            }
+        }
+        return extract_bits(idx, positions);
+    }
+
+    // Sampling of measurement outcomes from a state vector without collapsing it
+    //
+    // The cumulative probability table is built once (in parallel) and is then used to draw any number of shots, either
+    // by binary search (O(log(size)) per shot), or by merging sorted uniform variates with the table in a single sweep
+    // (O(size + shots)).
+    //
+    // If at most all but two of the qubits are measured, the table only contains the marginal distribution of the
+    // measured qubits (otherwise, the table has one entry per amplitude). Bit i of an outcome corresponds to the qubit
+    // located at positions[i] in the state vector.
+    //
+    // For a single shot, sample_once() avoids building the table altogether.
+    class Sampler
+    {
+    public:
+        enum class Method
+        {
+            automatic,
+            binary_search,
+            sorted_sweep,
+        };
+
+        static constexpr std::size_t max_histogram_size = 1UL << 22U;  // 32 MiB of partial histograms
+
+        template <class V>
+        Sampler(V const& psi, std::vector<unsigned> positions) : positions_(std::move(positions))
+        {
+            const auto size = psi.size();
+            check_positions(size, positions_);
+
+            marginal_ = (std::size_t(4) << positions_.size()) <= size;
+            if (marginal_) {
+                build_marginal_(psi);
+            }
+            else {
+                cdf_.resize(size);
+#pragma omp parallel for schedule(static)
+                for (std::size_t i = 0; i < size; ++i) {
+                    cdf_[i] = std::norm(psi[i]);
+                }
+            }
+            inclusive_scan_(cdf_);
+
+            if (!(total() > 0.)) {
+                throw std::invalid_argument("Sampler: the state vector has a zero norm!");
+            }
+        }
+
+        //! Total probability (1 for a normalized state)
+        [[nodiscard]] double total() const
+        {
+            return cdf_.empty() ? 0. : cdf_.back();
+        }
+
+        //! Cumulative probability table
+        [[nodiscard]] std::vector<double> const& cdf() const
+        {
+            return cdf_;
+        }
+
+        //! Outcome corresponding to the uniform variate u in [0, 1)
+        [[nodiscard]] std::size_t sample(double u) const
+        {
+            return outcome_(find_(u * total()));
+        }
+
+        //! Draw a number of independent outcomes
+        template <class RndEngine>
+        std::vector<std::size_t> sample(std::size_t shots, RndEngine& rng, Method method = Method::automatic) const
+        {
+            if (method == Method::automatic) {
+                const auto log_size = static_cast<double>(std::log2(static_cast<double>(cdf_.size()) + 1.));
+                method = static_cast<double>(shots) * log_size > static_cast<double>(cdf_.size())
+                             ? Method::sorted_sweep
+                             : Method::binary_search;
+            }
+
+            std::vector<std::size_t> res(shots);
+            std::uniform_real_distribution<double> dist(0., 1.);
+            if (method == Method::binary_search) {
+                for (auto& r: res) {
+                    r = sample(dist(rng));
+                }
+                return res;
+            }
+
+            // Sorted uniform variates from normalized partial sums of exponential variates
+            std::exponential_distribution<double> expo(1.);
+            std::vector<double> sorted(shots);
+            double sum = 0.;
+            for (auto& s: sorted) {
+                sum += expo(rng);
+                s = sum;
+            }
+            const auto scale = total() / (sum + expo(rng));
+
+            std::size_t j = 0;
+            for (std::size_t s = 0; s < shots; ++s) {
+                const auto x = std::min(sorted[s] * scale, last_below_total_());
+                while (cdf_[j] <= x) {
+                    ++j;
+                }
+                res[s] = outcome_(j);
+            }
+
+            // The outcomes are drawn in increasing order: restore independence between consecutive shots
+            std::shuffle(begin(res), end(res), rng);
+            return res;
+        }
+
+    private:
+        template <class V>
+        void build_marginal_(V const& psi)
+        {
+            const auto size = psi.size();
+            const auto num_bins = std::size_t(1) << positions_.size();
+            const auto num_chunks = (size + chunk_size - 1) / chunk_size;
+            const auto num_parts = std::clamp<std::size_t>(max_histogram_size / num_bins, 1, num_chunks);
+            const auto part_size = (size + num_parts - 1) / num_parts;
+
+            // One histogram per contiguous part of the state vector, summed afterwards (avoids atomics)
+            std::vector<double> hist(num_parts * num_bins, 0.);
+#pragma omp parallel for schedule(static)
+            for (std::size_t c = 0; c < num_parts; ++c) {
+                auto* h = &hist[c * num_bins];
+                const auto end = std::min(size, (c + 1) * part_size);
+                for (std::size_t i = c * part_size; i < end; ++i) {
+                    std::size_t bin = 0;
+                    for (std::size_t k = 0; k < positions_.size(); ++k) {
+                        bin |= ((i >> positions_[k]) & 1U) << k;
+                    }
+                    h[bin] += std::norm(psi[i]);
+                }
+            }
+
+            cdf_.assign(num_bins, 0.);
+#pragma omp parallel for schedule(static)
+            for (std::size_t b = 0; b < num_bins; ++b) {
+                for (std::size_t c = 0; c < num_parts; ++c) {
+                    cdf_[b] += hist[c * num_bins + b];
+                }
+            }
+        }
+
+        // Parallel inclusive prefix sum: per-chunk sums, serial scan of the chunk sums, then per-chunk scans
+        static void inclusive_scan_(std::vector<double>& v)
+        {
+            const auto size = v.size();
+            const auto num_chunks = (size + chunk_size - 1) / chunk_size;
+            std::vector<double> offsets(num_chunks, 0.);
+
+#pragma omp parallel for schedule(static)
+            for (std::size_t c = 0; c < num_chunks; ++c) {
+                const auto end = std::min(size, (c + 1) * chunk_size);
+                double sum = 0.;
+                for (std::size_t i = c * chunk_size; i < end; ++i) {
+                    sum += v[i];
+                }
+                offsets[c] = sum;
+            }
+
+            double running = 0.;
+            for (auto& offset: offsets) {
+                const auto sum = offset;
+                offset = running;
+                running += sum;
+            }
+
+#pragma omp parallel for schedule(static)
+            for (std::size_t c = 0; c < num_chunks; ++c) {
+                const auto end = std::min(size, (c + 1) * chunk_size);
+                double sum = offsets[c];
+                for (std::size_t i = c * chunk_size; i < end; ++i) {
+                    sum += v[i];
+                    v[i] = sum;
+                }
+            }
+        }
+
+        // Largest value strictly below the total probability (so that the search always ends on a valid entry)
+        [[nodiscard]] double last_below_total_() const
+        {
+            return std::nextafter(total(), 0.);
+        }
+
+        // Index of the first entry of the table whose cumulative probability is larger than x
+        [[nodiscard]] std::size_t find_(double x) const
+        {
+            x = std::min(x, last_below_total_());
+            return static_cast<std::size_t>(std::upper_bound(begin(cdf_), end(cdf_), x) - begin(cdf_));
+        }
+
+        // Convert an index of the table into an outcome
+        [[nodiscard]] std::size_t outcome_(std::size_t idx) const
+        {
+            return marginal_ ? idx : extract_bits(idx, positions_);
+        }
+
+        std::vector<unsigned> positions_;
+        bool marginal_ = false;
+        std::vector<double> cdf_;
+    };
+}  // namespace sampling
+
+#endif /* SAMPLING_HPP */
@@ -22,14 +22,16 @@ namespace backends
     // SIM backends
     enum class SimBackend
     {
-        Unknown = -1,    // Unknown or unsupported backend
-        Auto = 0,        // Best choice for the current system
-        ScalarSerial,    // Scalar instructions, single-threaded
-        ScalarThreaded,  // Scalar instructions, multi-threaded
-        VectorSerial,    // Vector instructions, single-threaded
-        VectorThreaded,  // Vector instructions, multi-threaded
-        OffloadNVIDIA,   // Offload to NVIDIA GPU
-        OffloadIntel,    // Offload to Intel GPU
+        Unknown = -1,          // Unknown or unsupported backend
+        Auto = 0,              // Best choice for the current system
+        ScalarSerial,          // Scalar instructions, single-threaded
+        ScalarThreaded,        // Scalar instructions, multi-threaded
+        VectorSerial,          // Vector instructions, single-threaded
+        VectorThreaded,        // Vector instructions, multi-threaded
+        VectorAVX512Serial,    // AVX-512 instructions, single-threaded
+        VectorAVX512Threaded,  // AVX-512 instructions, multi-threaded
+        OffloadNVIDIA,         // Offload to NVIDIA GPU
+        OffloadIntel,          // Offload to Intel GPU
     };
 
     // Read SIM backend from the environment variable.
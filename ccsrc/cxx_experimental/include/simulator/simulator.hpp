@@ -16,17 +16,29 @@
 #ifndef SIMULATOR_HPP_
 #define SIMULATOR_HPP_
 
+#include "adjoint_gradient.hpp"
 #include "fusion.hpp"
+#include "gate_kind.hpp"
+#include "layout_manager.hpp"
+#include "pauli_expectation.hpp"
+#include "pauli_grouping.hpp"
+#include "pauli_sum.hpp"
+#include "sampling.hpp"
 #include "simbackends.hpp"
+#include "sweep.hpp"
+#include "time_evolution.hpp"
 #include "types.hpp"
+#include "workspace_pool.hpp"
 
 #include <algorithm>
 #include <cmath>
+#include <complex>
 #include <functional>
 #include <map>
 #include <optional>
 #include <random>
 #include <tuple>
+#include <utility>
 
 namespace details
 {
@@ -40,48 +52,96 @@ namespace details
                                                  fusion::Fusion::IndexVector const&, unsigned);
 }  // namespace details
 
-class Simulator
+// State vector simulator
+//
+// calc_t is the floating point type of the amplitudes of the state vector (double or float). The gate matrices, the
+// gate fusion and the coefficients of the operators are always in double precision; single precision halves the
+// memory footprint (i.e. one more qubit for the same amount of memory) and the memory traffic of the kernels.
+template <typename calc_t>
+class BasicSimulator
 {
     static constexpr auto default_tol_ = 1.e-12;
     static constexpr auto max_qubit_num_ = 5U;
+    static constexpr auto default_sweep_tile_qubits_ = 14U;  // 256 KiB tiles
 
 public:
-    using calc_type = types::calc_type;
-    using complex_type = types::complex_type;
-    using StateVector = types::StateVector;
+    using calc_type = calc_t;
+    using complex_type = std::complex<calc_type>;
+    using StateVector = types::basic_state_vector<calc_type>;
     using Map = std::map<unsigned, unsigned>;
     using RndEngine = std::mt19937;
     using Term = std::vector<std::pair<unsigned, char>>;
     using TermsDict = std::vector<std::pair<Term, types::calc_type>>;
     using ComplexTermsDict = std::vector<std::pair<Term, types::complex_type>>;
 
-    using backend_kernel_t = decltype(details::kernel<types::V, types::M, types::UINT>);
+    using backend_kernel_t = void(StateVector&, types::M const&, types::UINT, fusion::Fusion::IndexVector const&,
+                                  unsigned);
+    using backend_structured_kernel_t = void(StateVector&, fusion::StructuredGate const&, types::UINT,
+                                             fusion::Fusion::IndexVector const&, unsigned);
+    using backend_sweep_kernel_t = void(StateVector&, fusion::FusedGate const*, std::size_t, unsigned);
+
+    // Keeps the state vector at the same address (no reallocation, no reordering of the qubits) while alive
+    //
+    // Zero-copy views of the state vector (e.g. NumPy arrays sharing its memory) hold a pin for as long as they
+    // exist. Gates, measurements and operators are still applied in place, but the operations that need to resize
+    // the state vector (qubit allocation and deallocation) throw while the state vector is pinned.
+    class StatePin
+    {
+    public:
+        explicit StatePin(BasicSimulator& sim) : sim_(&sim)
+        {
+            ++sim_->num_pins_;
+        }
+        StatePin(StatePin const&) = delete;
+        StatePin& operator=(StatePin const&) = delete;
+        StatePin(StatePin&& other) noexcept : sim_(std::exchange(other.sim_, nullptr))
+        {}
+        StatePin& operator=(StatePin&&) = delete;
+        ~StatePin()
+        {
+            if (sim_ != nullptr) {
+                --sim_->num_pins_;
+            }
+        }
 
-    explicit Simulator(unsigned seed = 1);
+    private:
+        BasicSimulator* sim_;
+    };
+
+    explicit BasicSimulator(unsigned seed = 1);
+
+    //! Use the given kernels instead of acquiring those of a backend module (e.g. kernels linked into the executable)
+    BasicSimulator(unsigned seed, backend_kernel_t* kernel, backend_structured_kernel_t* structured_kernel = nullptr,
+                   backend_sweep_kernel_t* sweep_kernel = nullptr);
+
+    bool has_qubit(unsigned id) const
+    {
+        return map_.count(id) != 0U;
+    }
 
     void allocate_qubit(unsigned id)
     {
-        if (map_.count(id) == 0U) {
-            map_[id] = N_++;
-            StateVector newvec;  // avoid large memory allocations
-            if (tmpBuff1_.capacity() >= (1UL << N_)) {
-                std::swap(newvec, tmpBuff1_);
-            }
-            newvec.resize(1UL << N_);
-#pragma omp parallel for schedule(static)
-            for (std::size_t i = 0; i < newvec.size(); ++i) {
-                newvec[i] = (i < vec_.size()) ? vec_[i] : 0.;
-            }
-            std::swap(vec_, newvec);
-            // recycle large memory
-            std::swap(tmpBuff1_, newvec);
-            if (tmpBuff1_.capacity() < tmpBuff2_.capacity()) {
-                std::swap(tmpBuff1_, tmpBuff2_);
-            }
+        allocate_qubits({id});
+    }
+
+    // Only the qubit mapping is updated here: the state vector is zero-extended to its new size by the next
+    // operation that accesses it. Allocating n qubits (one by one or at once) therefore costs a single reallocation
+    // and a single pass over the final state vector, instead of one per qubit.
+    void allocate_qubits(std::vector<unsigned> const& ids)
+    {
+        if (num_pins_ > 0) {
+            throw(std::runtime_error("AllocateQubit: the state vector is pinned by a view!"));
         }
-        else {
+        auto sorted = ids;
+        std::sort(begin(sorted), end(sorted));
+        if (std::adjacent_find(begin(sorted), end(sorted)) != end(sorted)
+            || std::any_of(begin(ids), end(ids), [this](unsigned id) { return map_.count(id) != 0U; })) {
             throw(std::runtime_error("AllocateQubit: ID already exists. Qubit IDs should be unique."));
         }
+
+        for (auto id: ids) {
+            map_[id] = N_++;
+        }
     }
 
     bool get_classical_value(unsigned id, calc_type tol = default_tol_)
@@ -125,6 +185,9 @@ public:
 
     void collapse_vector(unsigned id, bool value = false, bool shrink = false)
     {
+        if (shrink && num_pins_ > 0) {
+            throw(std::runtime_error("collapse_vector(): the state vector is pinned by a view!"));
+        }
         run();
         unsigned pos = map_[id];
         std::size_t delta = (1UL << pos);
@@ -138,20 +201,12 @@ public:
             }
         }
         else {
-            StateVector newvec;  // avoid costly memory reallocations
-            if (tmpBuff1_.capacity() >= (1UL << (N_ - 1UL))) {
-                std::swap(tmpBuff1_, newvec);
-            }
-            newvec.resize((1UL << (N_ - 1UL)));
+            auto newvec = workspace_.acquire(1UL << (N_ - 1UL));  // avoid costly memory reallocations
 #pragma omp parallel for schedule(static) if (0)
             for (std::size_t i = 0; i < vec_.size(); i += 2UL * delta) {
-                std::copy_n(&vec_[i + static_cast<std::size_t>(value) * delta], delta, &newvec[i / 2UL]);
-            }
-            std::swap(vec_, newvec);
-            std::swap(tmpBuff1_, newvec);
-            if (tmpBuff1_.capacity() < tmpBuff2_.capacity()) {
-                std::swap(tmpBuff1_, tmpBuff2_);
+                std::copy_n(&vec_[i + static_cast<std::size_t>(value) * delta], delta, &(*newvec)[i / 2UL]);
             }
+            std::swap(vec_, *newvec);
 
             for (auto& p: map_) {
                 if (p.second > pos) {
@@ -172,23 +227,17 @@ public:
             positions[i] = map_[ids[i]];
         }
 
-        calc_type P = 0.;
-        calc_type rnd = rng_();
+        // pick outcome at random with probability given by the marginal distribution of the measured qubits
+        // (single shot: no probability table, see sampling::sample_once())
+        const auto pick = sampling::sample_once(vec_, positions, rng_());
 
-        // pick entry at random with probability |entry|^2
-        std::size_t pick = 0;
-        while (P < rnd && pick < vec_.size()) {
-            P += std::norm(vec_[pick++]);
-        }
-
-        pick--;
         // determine result vector (boolean values for each qubit)
         // and create mask to detect bad entries (i.e., entries that don't agree with measurement)
         res = std::vector<bool>(ids.size());
         std::size_t mask = 0;
         std::size_t val = 0;
         for (unsigned i = 0; i < ids.size(); ++i) {
-            bool r = ((pick >> positions[i]) & 1) == 1;  // NOLINT
+            bool r = ((pick >> i) & 1) == 1;  // NOLINT
             res[i] = r;
             mask |= (1UL << positions[i]);
             val |= (static_cast<std::size_t>(static_cast<unsigned int>(r) & 1U) << positions[i]);
@@ -219,6 +268,27 @@ public:
         return ret;
     }
 
+    //! Sample the measurement outcomes of some qubits, without collapsing the state vector
+    /*!
+     * The cumulative probability table is built once for all the shots, so that the cost scales with the number of
+     * shots and not with the number of shots times the size of the state vector.
+     *
+     * \return One outcome per shot, with bit i of each outcome corresponding to qubit ids[i]
+     */
+    std::vector<std::size_t> sample_qubits(std::vector<unsigned> const& ids, std::size_t shots)
+    {
+        run();
+        if (!check_ids(ids)) {
+            throw(std::runtime_error("sample_qubits(): Unknown qubit id(s) provided."));
+        }
+
+        std::vector<unsigned> positions(ids.size());
+        for (unsigned i = 0; i < ids.size(); ++i) {
+            positions[i] = map_[ids[i]];
+        }
+        return sampling::Sampler(vec_, positions).sample(shots, rnd_eng_);
+    }
+
     void deallocate_qubit(unsigned id)
     {
         run();
@@ -267,11 +337,8 @@ public:
             }
         }
 
-        StateVector newvec;  // avoid costly memory reallocations
-        if (tmpBuff1_.capacity() >= vec_.size()) {
-            std::swap(newvec, tmpBuff1_);
-        }
-        newvec.resize(vec_.size());
+        auto buffer = workspace_.acquire(vec_.size());  // avoid costly memory reallocations
+        auto& newvec = *buffer;
 #pragma omp parallel for schedule(static)
         for (std::size_t i = 0; i < vec_.size(); i++) {
             newvec[i] = 0;
@@ -306,8 +373,7 @@ public:
                 }
             }
         }
-        std::swap(vec_, newvec);
-        std::swap(tmpBuff1_, newvec);
+        replace_state_(newvec);
     }
 
     // faster version without calling python
@@ -350,71 +416,117 @@ public:
             quregs, ctrl, true);
     }
 
+    // Evaluated directly from the X/Y/Z masks of each term in a single read-only pass over the state vector (no copy
+    // of the state, no gate applications)
     calc_type get_expectation_value(TermsDict const& td, std::vector<unsigned> const& ids)
     {
         run();
-        calc_type expectation = 0.;
 
-        StateVector current_state;  // avoid costly memory reallocations
-        if (tmpBuff1_.capacity() >= vec_.size()) {
-            std::swap(tmpBuff1_, current_state);
-        }
-        current_state.resize(vec_.size());
-#pragma omp parallel for schedule(static)
-        for (std::size_t i = 0; i < vec_.size(); ++i) {
-            current_state[i] = vec_[i];
+        std::vector<pauli::PauliMask> masks;
+        masks.reserve(td.size());
+        for (auto const& term: td) {
+            masks.push_back(pauli::make_pauli_mask(term.first, [this, &ids](unsigned idx) { return map_[ids[idx]]; }));
         }
 
-        for (auto const& term: td) {
-            auto const& coefficient = term.second;
-            apply_term(term.first, ids, {});
-            calc_type delta = 0.;
-#pragma omp parallel for reduction(+ : delta) schedule(static)
-            for (std::size_t i = 0; i < vec_.size(); ++i) {
-                auto const a1 = std::real(current_state[i]);
-                auto const b1 = -std::imag(current_state[i]);
-                auto const a2 = std::real(vec_[i]);
-                auto const b2 = std::imag(vec_[i]);
-                delta += a1 * a2 - b1 * b2;
-                // reset vec_
-                vec_[i] = current_state[i];
-            }
-            expectation += coefficient * delta;
+        const auto values = pauli::expectation_values(vec_, masks);
+        calc_type expectation = 0.;
+        for (std::size_t t = 0; t < td.size(); ++t) {
+            expectation += td[t].second * values[t];
         }
-        std::swap(current_state, tmpBuff1_);
         return expectation;
     }
 
-    void apply_qubit_operator(ComplexTermsDict const& td, std::vector<unsigned> const& ids)
+    calc_type get_expectation_value(pauli::CompiledPauliSum const& op, std::vector<unsigned> const& ids)
     {
         run();
-        StateVector new_state;
-        StateVector current_state;  // avoid costly memory reallocations
-        if (tmpBuff1_.capacity() >= vec_.size()) {
-            std::swap(tmpBuff1_, new_state);
+        return static_cast<calc_type>(physical_operator(op, ids).expectation(vec_));
+    }
+
+    // Expectation value of a Hermitian operator and its gradient with respect to the parameters of a circuit
+    //
+    // The current state must be the result of applying the gates of the circuit, which refer to the qubits by their
+    // id. All the derivatives are obtained with the adjoint method in a single backward sweep over the circuit using
+    // two work buffers; the state of the simulator is left untouched.
+    adjoint::Result get_expectation_with_gradient(pauli::CompiledPauliSum const& op, std::vector<unsigned> const& ids,
+                                                  std::vector<adjoint::Gate> const& circuit, std::size_t num_params)
+    {
+        run();
+        auto physical = circuit;
+        for (auto& gate: physical) {
+            if (!check_ids(gate.ids) || !check_ids(gate.ctrls)) {
+                throw(std::runtime_error("get_expectation_with_gradient(): Unknown qubit id."));
+            }
+            for (auto& id: gate.ids) {
+                id = map_[id];
+            }
+            for (auto& ctrl: gate.ctrls) {
+                ctrl = map_[ctrl];
+            }
         }
-        if (tmpBuff2_.capacity() >= vec_.size()) {
-            std::swap(tmpBuff2_, current_state);
+
+        auto phi = workspace_.acquire(vec_.size());  // avoid costly memory reallocations
+        auto lambda = workspace_.acquire(vec_.size());
+        return adjoint::gradient(vec_, physical, physical_operator(op, ids), num_params, *phi, *lambda);
+    }
+
+    // Partition the terms of a Hamiltonian into qubit-wise commuting groups
+    //
+    // The grouping refers to the qubits by their index in the ids argument of get_expectation_value(), so it does not
+    // depend on the current layout of the state vector and can be reused for all evaluations of the same Hamiltonian.
+    static pauli::PauliGrouping group_terms(TermsDict const& td)
+    {
+        std::vector<pauli::PauliMask> masks;
+        masks.reserve(td.size());
+        for (auto const& term: td) {
+            masks.push_back(pauli::make_pauli_mask(term.first, [](unsigned idx) { return idx; }));
         }
-        new_state.resize(vec_.size());
-        current_state.resize(vec_.size());
-#pragma omp parallel for schedule(static)
-        for (std::size_t i = 0; i < vec_.size(); ++i) {
-            new_state[i] = 0;
-            current_state[i] = vec_[i];
+        return pauli::group_qubit_wise(masks);
+    }
+
+    // Evaluated group by group: one diagonal sweep per group after the shared basis change
+    calc_type get_expectation_value(TermsDict const& td, pauli::PauliGrouping const& grouping,
+                                    std::vector<unsigned> const& ids)
+    {
+        if (grouping.masks.size() != td.size()) {
+            throw(std::runtime_error("get_expectation_value(): grouping does not match the terms!"));
         }
-        for (auto const& term: td) {
-            auto const& coefficient = term.second;
-            apply_term(term.first, ids, {});
-#pragma omp parallel for schedule(static)
-            for (std::size_t i = 0; i < vec_.size(); ++i) {
-                new_state[i] += coefficient * vec_[i];
-                vec_[i] = current_state[i];
-            }
+        run();
+
+        const auto physical = pauli::remap(grouping, [this, &ids](unsigned idx) { return map_[ids[idx]]; });
+
+        auto workspace = workspace_.acquire(vec_.size());  // avoid costly memory reallocations
+        const auto values = pauli::grouped_expectation_values(vec_, physical, *workspace);
+
+        calc_type expectation = 0.;
+        for (std::size_t t = 0; t < td.size(); ++t) {
+            expectation += td[t].second * values[t];
         }
-        std::swap(vec_, new_state);
-        std::swap(tmpBuff1_, new_state);
-        std::swap(tmpBuff2_, current_state);
+        return expectation;
+    }
+
+    // Compile the terms of a Pauli sum once for repeated use
+    //
+    // The qubits are referred to by their index in the ids argument of apply_qubit_operator(),
+    // emulate_time_evolution() and get_expectation_value(), so the result does not depend on the current layout of the
+    // state vector.
+    template <typename terms_t>
+    static pauli::CompiledPauliSum compile_terms(terms_t const& td)
+    {
+        return pauli::CompiledPauliSum(td, [](unsigned idx) { return idx; });
+    }
+
+    void apply_qubit_operator(ComplexTermsDict const& td, std::vector<unsigned> const& ids)
+    {
+        apply_qubit_operator(compile_terms(td), ids);
+    }
+
+    // Each amplitude of the new state is computed in a single pass over the old one
+    void apply_qubit_operator(pauli::CompiledPauliSum const& op, std::vector<unsigned> const& ids)
+    {
+        run();
+        auto new_state = workspace_.acquire(vec_.size());  // avoid costly memory reallocations
+        physical_operator(op, ids).apply(vec_, *new_state);
+        replace_state_(*new_state);
     }
 
     calc_type get_probability(std::vector<bool> const& bit_string, std::vector<unsigned> const& ids)
@@ -463,66 +575,50 @@ public:
     // NOLINTNEXTLINE
     void emulate_time_evolution(TermsDict const& tdict, calc_type const& time, std::vector<unsigned> const& ids,
                                 std::vector<unsigned> const& ctrl)
+    {
+        emulate_time_evolution(compile_terms(tdict), time, ids, ctrl);
+    }
+
+    // exp(-i H t) computed by the propagator selected with set_evolution_options()
+    //
+    // H|psi> is restricted to the amplitudes where all the control qubits are in state |1>.
+    void emulate_time_evolution(pauli::CompiledPauliSum const& op, calc_type const& time,
+                                std::vector<unsigned> const& ids, std::vector<unsigned> const& ctrl)
     {
         run();
-        complex_type I(0., 1.);
-        calc_type tr = 0.;
-        calc_type op_nrm = 0.;
-        TermsDict td;
-        for (const auto& i: tdict) {
-            if (i.first.empty()) {
-                tr += i.second;
-            }
-            else {
-                td.push_back(i);
-                op_nrm += std::abs(i.second);
-            }
-        }
-        auto s = static_cast<unsigned>(std::abs(time) * op_nrm + 1.);
-        complex_type correction = std::exp(-time * I * tr / static_cast<double>(s));
-        auto output_state = vec_;
-        auto ctrlmask = get_control_mask(ctrl);
-        for (unsigned i = 0; i < s; ++i) {
-            calc_type nrm_change = 1.;
-            for (unsigned k = 0; nrm_change > default_tol_; ++k) {
-                auto coeff = (-time * I) / double(s * (k + 1));
-                auto current_state = vec_;
-                auto update = StateVector(vec_.size(), 0.);
-                for (auto const& tup: td) {
-                    apply_term(tup.first, ids, {});
-#pragma omp parallel for schedule(static)
-                    for (std::size_t j = 0; j < vec_.size(); ++j) {
-                        update[j] += vec_[j] * tup.second;
-                        vec_[j] = current_state[j];
-                    }
-                }
-                nrm_change = 0.;
-#pragma omp parallel for reduction(+ : nrm_change) schedule(static)
-                for (std::size_t j = 0; j < vec_.size(); ++j) {
-                    update[j] *= coeff;
-                    vec_[j] = update[j];
-                    if ((j & ctrlmask) == ctrlmask) {
-                        output_state[j] += update[j];
-                        nrm_change += std::norm(update[j]);
-                    }
-                }
-                nrm_change = std::sqrt(nrm_change);
-            }
-#pragma omp parallel for schedule(static)
-            for (std::size_t j = 0; j < vec_.size(); ++j) {
-                if ((j & ctrlmask) == ctrlmask) {
-                    output_state[j] *= correction;
-                }
-                vec_[j] = output_state[j];
-            }
-        }
+        const auto physical = physical_operator(op, ids);
+        const auto ctrlmask = get_control_mask(ctrl);
+        auto apply_h = [&physical, ctrlmask](StateVector const& src, StateVector& dst) {
+            physical.apply(src, dst, ctrlmask);
+        };
+        evolution::Workspace<StateVector> workspace(workspace_);  // buffers returned to the pool on exit
+        evolution::evolve(vec_, apply_h, time, physical.radius(), workspace, evolution_options_);
+    }
+
+    //! Select the propagator used by emulate_time_evolution() (Lanczos by default)
+    void set_evolution_options(evolution::Options const& options)
+    {
+        evolution_options_ = options;
+    }
+
+    [[nodiscard]] evolution::Options const& get_evolution_options() const
+    {
+        return evolution_options_;
     }
 
     void set_wavefunction(StateVector const& wavefunction, std::vector<unsigned> const& ordering)
+    {
+        set_wavefunction(wavefunction.data(), wavefunction.size(), ordering);
+    }
+
+    // Copy the amplitudes straight from an external buffer (e.g. a NumPy array) into the state vector, without any
+    // intermediate StateVector
+    template <typename T>
+    void set_wavefunction(std::complex<T> const* wavefunction, std::size_t size, std::vector<unsigned> const& ordering)
     {
         run();
         // make sure there are 2^n amplitudes for n qubits
-        if (wavefunction.size() != (1UL << ordering.size())) {
+        if (size != (1UL << ordering.size())) {
             throw(std::runtime_error("set_wavefunction: size mismatch between wavefunction and ordering!"));
         }
         // check that all qubits have been allocated previously
@@ -532,13 +628,22 @@ public:
                                    "been allocated previously (call eng.flush())."));
         }
 
+        // NB: the mapping attached to existing views must remain valid
+        if (num_pins_ > 0) {
+            for (unsigned i = 0; i < ordering.size(); ++i) {
+                if (map_[ordering[i]] != i) {
+                    throw(std::runtime_error("set_wavefunction(): cannot change the qubit mapping of a pinned state!"));
+                }
+            }
+        }
+
         // set mapping and wavefunction
         for (unsigned i = 0; i < ordering.size(); ++i) {
             map_[ordering[i]] = i;
         }
 #pragma omp parallel for schedule(static)
-        for (std::size_t i = 0; i < wavefunction.size(); ++i) {
-            vec_[i] = wavefunction[i];
+        for (std::size_t i = 0; i < size; ++i) {
+            vec_[i] = complex_type(wavefunction[i]);
         }
     }
 
@@ -587,25 +692,117 @@ public:
 
     void run();
 
+    //! Apply a list of fused gate blocks (e.g. as produced by fusion::FusionPlanner) to the state vector
+    /*!
+     * \note Any gates still pending in the online fusion buffer are applied first.
+     */
+    void apply_fused_blocks(std::vector<fusion::Fusion>& blocks);
+
+    //! Maximum number of qubits a fused gate block may act on
+    static constexpr unsigned max_fusion_qubits()
+    {
+        return max_qubit_num_;
+    }
+
+    //! Set the number of qubits of the cache tiles used by apply_fused_blocks()
+    /*!
+     * Consecutive blocks acting only on qubits (physical index) below \c tile_qubits are applied tile by tile, in a
+     * single pass over the state vector (counted as a single kernel launch). A value of 0 disables the tiling.
+     */
+    void set_sweep_tile_qubits(unsigned tile_qubits)
+    {
+        sweep_tile_qubits_ = tile_qubits;
+    }
+
+    [[nodiscard]] unsigned sweep_tile_qubits() const
+    {
+        return sweep_tile_qubits_;
+    }
+
+    //! Enable (or disable with std::nullopt) the automatic reordering of the qubits in the state vector
+    /*!
+     * The layout manager moves the most frequently used qubits into the low-order bits of the state vector. The
+     * qubit mapping is updated accordingly, so this is transparent to the callers (see cheat()).
+     */
+    void set_layout_manager(std::optional<layout::LayoutManager> manager)
+    {
+        layout_manager_ = std::move(manager);
+    }
+
+    //! Return the layout manager (if any)
+    [[nodiscard]] std::optional<layout::LayoutManager> const& get_layout_manager() const
+    {
+        return layout_manager_;
+    }
+
+    //! Return the total number of backend kernel launches since the creation of the simulator
+    [[nodiscard]] std::size_t get_kernel_launches() const
+    {
+        return kernel_launches_;
+    }
+
     std::tuple<Map, StateVector&> cheat()
     {
         run();
         return make_tuple(map_, std::ref(vec_));
     }
 
+    //! Apply all pending gates and pin the state vector (see StatePin)
+    /*!
+     * As long as the pin is alive, the mapping returned by cheat() remains valid and the memory of the state vector
+     * can be shared with external code without copies.
+     */
+    [[nodiscard]] StatePin pin_state()
+    {
+        run();
+        return StatePin(*this);
+    }
+
+    [[nodiscard]] bool is_state_pinned() const
+    {
+        return num_pins_ > 0;
+    }
+
 private:
-    void apply_term(Term const& term, std::vector<unsigned> const& ids, std::vector<unsigned> const& ctrl)
+    void apply_fusion_(fusion::Fusion& fused_gates);
+    void update_layout_();
+    fusion::FusedGate prepare_fusion_(fusion::Fusion& fused_gates);
+    void apply_fused_gate_(fusion::FusedGate const& gate);
+
+    // Zero-extend the state vector to 2^N_ amplitudes after qubit allocations
+    void extend_state_()
     {
-        complex_type I(0., 1.);
-        types::M X = {0., 1., 1., 0.};
-        types::M Y = {0., -I, I, 0.};
-        types::M Z = {1., 0., 0., -1.};
-        std::vector<types::M> gates = {X, Y, Z};
-        for (auto const& local_op: term) {
-            unsigned id = ids[local_op.first];
-            apply_controlled_gate(gates[local_op.second - 'X'], {id}, ctrl);
+        const auto size = std::size_t(1) << N_;
+        if (vec_.size() == size) {
+            return;
+        }
+        auto newvec = workspace_.acquire(size);  // avoid large memory allocations
+        const auto old_size = vec_.size();
+#pragma omp parallel for schedule(static)
+        for (std::size_t i = 0; i < size; ++i) {
+            (*newvec)[i] = i < old_size ? vec_[i] : complex_type(0.);
+        }
+        // NB: the old state vector is recycled by the pool
+        std::swap(vec_, *newvec);
+    }
+
+    // Replace the content of the state vector, in place if it is pinned
+    void replace_state_(StateVector& new_state)
+    {
+        if (num_pins_ > 0) {
+#pragma omp parallel for schedule(static)
+            for (std::size_t i = 0; i < vec_.size(); ++i) {
+                vec_[i] = new_state[i];
+            }
+        }
+        else {
+            // NB: the old state vector is recycled by the pool
+            std::swap(vec_, new_state);
         }
-        run();
+    }
+    pauli::CompiledPauliSum physical_operator(pauli::CompiledPauliSum const& op, std::vector<unsigned> const& ids)
+    {
+        return op.remapped([this, &ids](unsigned idx) { return map_[ids[idx]]; });
     }
     std::size_t get_control_mask(std::vector<unsigned> const& ctrls)
     {
@@ -630,9 +827,23 @@ private:
     std::function<double()> rng_;
     backends::SimBackend backend_type_;
     backend_kernel_t* backend_kernel_;
+    backend_structured_kernel_t* backend_structured_kernel_;  // nullptr if not provided by the backend
+    backend_sweep_kernel_t* backend_sweep_kernel_;            // nullptr if not provided by the backend
+    unsigned sweep_tile_qubits_;
+    std::optional<layout::LayoutManager> layout_manager_;
+    std::size_t kernel_launches_;
+    evolution::Options evolution_options_;
 
     // large array buffers to avoid costly reallocations
-    static StateVector tmpBuff1_, tmpBuff2_;  // NOLINT
+    memory::WorkspacePool<StateVector> workspace_;
+
+    std::size_t num_pins_;  // number of live StatePin instances
 };
 
+extern template class BasicSimulator<double>;
+extern template class BasicSimulator<float>;
+
+using Simulator = BasicSimulator<types::calc_type>;
+using SimulatorFloat = BasicSimulator<float>;
+
 #endif
@@ -0,0 +1,276 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef STRUCTURED_KERNELS_HPP
+#define STRUCTURED_KERNELS_HPP
+
+#include "cintrin.hpp"
+#include "dispatch.hpp"
+#include "for_each.hpp"
+#include "gate_kind.hpp"
+#include "kernel_counter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <type_traits>
+
+// Kernels for diagonal and (phased) permutation gates
+//
+// Contrary to the dense kernelN::core(), these kernels perform a single complex multiplication (diagonal gates) or a
+// single move, optionally followed by a multiplication (permutation gates), per amplitude of the state vector.
+
+namespace details
+{
+    namespace structured
+    {
+        static constexpr auto max_dim = fusion::StructuredGate::max_dim;
+
+        // Indices of the target qubits, sorted in increasing order, and offsets of all the amplitudes of a group
+        //
+        // Only the groups that satisfy the controls are enumerated: the control bits are inserted into the group index
+        // (see details::ctrl_insertion) before the target bits.
+        template <typename UINT>
+        struct Layout
+        {
+            Layout(const unsigned* ids, unsigned num_ids, UINT ctrlmask) : nids(num_ids)
+            {
+                std::copy_n(ids, nids, begin(sorted));
+                std::sort(begin(sorted), begin(sorted) + nids);
+                ctrl = ctrl_insertion<UINT>(ctrlmask, sorted.data(), nids);
+                for (std::size_t j = 0; j < (1UL << nids); ++j) {
+                    for (unsigned l = 0; l < nids; ++l) {
+                        if (((j >> l) & 1UL) != 0U) {
+                            offsets[j] |= UINT(1) << ids[l];
+                        }
+                    }
+                }
+            }
+
+            // Number of groups of a state vector of the given size that satisfy the controls
+            [[nodiscard]] UINT num_groups(UINT size) const
+            {
+                return size >> (nids + ctrl.count);
+            }
+
+            // Index of the first amplitude of group g (insert the control bits, then a zero bit at the position of each
+            // target qubit)
+            [[nodiscard]] UINT base(UINT g) const
+            {
+                g = ctrl.apply(g);
+                for (unsigned l = 0; l < nids; ++l) {
+                    const auto low = (UINT(1) << sorted[l]) - 1U;
+                    g = ((g & ~low) << 1U) | (g & low);
+                }
+                return g;
+            }
+
+            unsigned nids;
+            std::array<unsigned, 5> sorted{};
+            std::array<UINT, max_dim> offsets{};
+            ctrl_insertion<UINT> ctrl;
+        };
+
+        template <typename UINT, typename func_t>
+        inline void for_each_group(UINT ngroups, func_t&& func)
+        {
+            details::kernel_counter<UINT, std::ptrdiff_t, 0> counter(ngroups);
+            parallel::for_each(counter, std::forward<func_t>(func));
+        }
+
+        template <typename T, typename UINT>
+        inline void apply_scalar(std::complex<T>* psi, UINT size, fusion::StructuredGate const& gate,
+                                 Layout<UINT> const& layout)
+        {
+            const auto& off = layout.offsets;
+            const auto& perm = gate.perm;
+            const auto dim = gate.dim;
+            const UINT ngroups = layout.num_groups(size);
+
+            // NB: the phases are stored in double precision
+            std::array<std::complex<T>, max_dim> phases;
+            std::copy_n(begin(gate.phases), dim, begin(phases));
+
+            switch (gate.kind) {
+                case fusion::GateKind::diagonal:
+                    for_each_group(ngroups, [&](UINT g) {
+                        const auto base = layout.base(g);
+                        for (unsigned j = 0; j < dim; ++j) {
+                            psi[base + off[j]] *= phases[j];
+                        }
+                    });
+                    break;
+                case fusion::GateKind::permutation:
+                    for_each_group(ngroups, [&](UINT g) {
+                        const auto base = layout.base(g);
+                        std::array<std::complex<T>, max_dim> v;
+                        for (unsigned j = 0; j < dim; ++j) {
+                            v[j] = psi[base + off[j]];
+                        }
+                        for (unsigned i = 0; i < dim; ++i) {
+                            psi[base + off[i]] = v[perm[i]];
+                        }
+                    });
+                    break;
+                case fusion::GateKind::phased_permutation:
+                    for_each_group(ngroups, [&](UINT g) {
+                        const auto base = layout.base(g);
+                        std::array<std::complex<T>, max_dim> v;
+                        for (unsigned j = 0; j < dim; ++j) {
+                            v[j] = psi[base + off[j]];
+                        }
+                        for (unsigned i = 0; i < dim; ++i) {
+                            psi[base + off[i]] = phases[i] * v[perm[i]];
+                        }
+                    });
+                    break;
+                case fusion::GateKind::general:
+                default:
+                    break;
+            }
+        }
+
+#if defined(INTRIN) && !defined(NOINTRIN) && defined(__AVX2__)
+        // Broadcast a complex number c as (re, im, re, im) and (im, -re, im, -re) for details::mul()
+        inline void broadcast(std::complex<double> c, intrin_t& m, intrin_t& mt)
+        {
+            m = _mm256_setr_pd(c.real(), c.imag(), c.real(), c.imag());
+            mt = _mm256_setr_pd(c.imag(), -c.real(), c.imag(), -c.real());
+        }
+
+        // Pairs of groups that only differ in the lowest bit are processed together, so that each AVX2 register
+        // holds two contiguous amplitudes with the same local index. Only valid if qubit 0 is neither a target nor a
+        // control qubit.
+        template <typename UINT>
+        inline void apply_paired_groups(std::complex<double>* psi, UINT size, fusion::StructuredGate const& gate,
+                                        Layout<UINT> const& layout)
+        {
+            const auto& off = layout.offsets;
+            const auto& perm = gate.perm;
+            const auto dim = gate.dim;
+            const UINT npairs = layout.num_groups(size) / 2U;
+
+            intrin_t m[max_dim];
+            intrin_t mt[max_dim];
+            for (unsigned j = 0; j < dim; ++j) {
+                broadcast(gate.phases[j], m[j], mt[j]);
+            }
+
+            auto load_at = [psi](UINT idx) { return _mm256_loadu_pd(reinterpret_cast<double const*>(psi + idx)); };
+            auto store_at = [psi](UINT idx, intrin_t v) { _mm256_storeu_pd(reinterpret_cast<double*>(psi + idx), v); };
+
+            switch (gate.kind) {
+                case fusion::GateKind::diagonal:
+                    for_each_group(npairs, [&](UINT p) {
+                        const auto base = layout.base(2U * p);
+                        for (unsigned j = 0; j < dim; ++j) {
+                            store_at(base + off[j], mul(load_at(base + off[j]), m[j], mt[j]));
+                        }
+                    });
+                    break;
+                case fusion::GateKind::permutation:
+                    for_each_group(npairs, [&](UINT p) {
+                        const auto base = layout.base(2U * p);
+                        intrin_t v[max_dim];
+                        for (unsigned j = 0; j < dim; ++j) {
+                            v[j] = load_at(base + off[j]);
+                        }
+                        for (unsigned i = 0; i < dim; ++i) {
+                            store_at(base + off[i], v[perm[i]]);
+                        }
+                    });
+                    break;
+                case fusion::GateKind::phased_permutation:
+                    for_each_group(npairs, [&](UINT p) {
+                        const auto base = layout.base(2U * p);
+                        intrin_t v[max_dim];
+                        for (unsigned j = 0; j < dim; ++j) {
+                            v[j] = load_at(base + off[j]);
+                        }
+                        for (unsigned i = 0; i < dim; ++i) {
+                            store_at(base + off[i], mul(v[perm[i]], m[i], mt[i]));
+                        }
+                    });
+                    break;
+                case fusion::GateKind::general:
+                default:
+                    break;
+            }
+        }
+
+        // Diagonal gate acting on qubit 0: the amplitudes of local indices j and j | 1 are contiguous in memory.
+        template <typename UINT>
+        inline void apply_diagonal_low(std::complex<double>* psi, UINT size, fusion::StructuredGate const& gate,
+                                       Layout<UINT> const& layout, unsigned low)
+        {
+            const auto& off = layout.offsets;
+            const auto dim = gate.dim;
+            const UINT ngroups = layout.num_groups(size);
+            const auto low_bit = 1U << low;
+
+            intrin_t m[max_dim];
+            intrin_t mt[max_dim];
+            for (unsigned j = 0; j < dim; ++j) {
+                if ((j & low_bit) == 0U) {
+                    const auto c0 = gate.phases[j];
+                    const auto c1 = gate.phases[j | low_bit];
+                    m[j] = _mm256_setr_pd(c0.real(), c0.imag(), c1.real(), c1.imag());
+                    mt[j] = _mm256_setr_pd(c0.imag(), -c0.real(), c1.imag(), -c1.real());
+                }
+            }
+
+            for_each_group(ngroups, [&](UINT g) {
+                const auto base = layout.base(g);
+                for (unsigned j = 0; j < dim; ++j) {
+                    if ((j & low_bit) == 0U) {
+                        auto* p = reinterpret_cast<double*>(psi + base + off[j]);
+                        _mm256_storeu_pd(p, mul(_mm256_loadu_pd(p), m[j], mt[j]));
+                    }
+                }
+            });
+        }
+#endif  // INTRIN && !NOINTRIN && __AVX2__
+    }  // namespace structured
+
+    // Apply a diagonal or (phased) permutation gate on the state vector
+    //
+    // Bit l of the local index of the gate corresponds to qubit ids[l] (same convention as the dense kernels).
+    template <class V, typename UINT>
+    inline void kernel_structured(V& psi_, fusion::StructuredGate const& gate, UINT ctrlmask, const unsigned* ids,
+                                  unsigned nids)
+    {
+        const structured::Layout<UINT> layout(ids, nids, ctrlmask);
+        auto* psi = &psi_[0];
+        const UINT size = psi_.size();
+
+#if defined(INTRIN) && !defined(NOINTRIN) && defined(__AVX2__)
+        if constexpr (std::is_same_v<std::remove_reference_t<decltype(*psi)>, std::complex<double>>) {
+            if (layout.sorted[0] != 0U && (ctrlmask & 1U) == 0U) {
+                structured::apply_paired_groups(psi, size, gate, layout);
+                return;
+            }
+            if (gate.kind == fusion::GateKind::diagonal && layout.sorted[0] == 0U) {
+                const auto low = static_cast<unsigned>(std::find(ids, ids + nids, 0U) - ids);
+                structured::apply_diagonal_low(psi, size, gate, layout, low);
+                return;
+            }
+        }
+#endif  // INTRIN && !NOINTRIN && __AVX2__
+
+        structured::apply_scalar(psi, size, gate, layout);
+    }
+}  // namespace details
+
+#endif /* STRUCTURED_KERNELS_HPP */
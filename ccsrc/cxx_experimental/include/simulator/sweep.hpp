@@ -0,0 +1,120 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef SWEEP_HPP
+#define SWEEP_HPP
+
+#include "for_each.hpp"
+#include "fusion.hpp"
+#include "gate_kind.hpp"
+#include "kernel_counter.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace fusion
+{
+    // A fused gate block ready to be applied on the state vector
+    //
+    // ids contains the physical indices of the target qubits (padded to the maximum number of qubits of a fused
+    // gate), ctrlmask the physical control mask.
+    struct FusedGate
+    {
+        Fusion::Matrix matrix;
+        Fusion::IndexVector ids;
+        unsigned nids = 0;
+        std::size_t ctrlmask = 0;
+        StructuredGate structure;
+
+        // Number of low-order qubits the gate needs to be contained in a tile (i.e. highest target qubit + 1)
+        [[nodiscard]] unsigned span() const
+        {
+            return nids == 0 ? 0U : *std::max_element(ids.begin(), ids.begin() + nids) + 1U;
+        }
+    };
+}  // namespace fusion
+
+namespace details
+{
+    // Non-owning view on a contiguous chunk of the state vector, usable in place of a StateVector by the kernels
+    template <typename T>
+    class state_view
+    {
+    public:
+        using value_type = T;
+
+        state_view(T* data, std::size_t size) : data_(data), size_(size)
+        {}
+
+        [[nodiscard]] std::size_t size() const
+        {
+            return size_;
+        }
+        [[nodiscard]] T* data() const
+        {
+            return data_;
+        }
+        T& operator[](std::size_t i) const
+        {
+            return data_[i];
+        }
+
+    private:
+        T* data_;
+        std::size_t size_;
+    };
+
+    // Cache-blocked application of a sequence of fused gates
+    //
+    // The state vector is split into tiles of 2^tile_qubits amplitudes. All the gates must have their target qubits
+    // within the tile (i.e. gate.span() <= tile_qubits); their control qubits may be anywhere. Each tile is loaded
+    // once and all the gates are applied on it before moving to the next tile, instead of sweeping over the whole
+    // state vector for every gate. Controls located above the tile are constant within a tile: the gate is either
+    // skipped or applied with the remaining low-order controls.
+    //
+    // dense(view, matrix, ctrlmask, ids, nids) and structured(view, structure, ctrlmask, ids, nids) apply a gate on a
+    // tile.
+    template <class V, typename dense_t, typename structured_t>
+    void sweep(V& psi, fusion::FusedGate const* gates, std::size_t ngates, unsigned tile_qubits, dense_t&& dense,
+               structured_t&& structured)
+    {
+        using view_t = state_view<typename V::value_type>;
+
+        const auto tile_size = std::min<std::size_t>(std::size_t(1) << tile_qubits, psi.size());
+        const auto lowmask = tile_size - 1U;
+        auto* data = &psi[0];
+
+        // NB: the kernels called within a tile run serially (nested parallel regions)
+        kernel_counter<std::size_t, std::ptrdiff_t, 0> tiles(psi.size() / tile_size);
+        parallel::for_each(tiles, [&](std::size_t tile) {
+            const auto offset = tile * tile_size;
+            view_t view(data + offset, tile_size);
+            for (std::size_t g = 0; g < ngates; ++g) {
+                const auto& gate = gates[g];
+                const auto highctrl = gate.ctrlmask & ~lowmask;
+                if ((offset & highctrl) != highctrl) {
+                    continue;
+                }
+                if (gate.structure.kind != fusion::GateKind::general) {
+                    structured(view, gate.structure, gate.ctrlmask & lowmask, gate.ids, gate.nids);
+                }
+                else {
+                    dense(view, gate.matrix, gate.ctrlmask & lowmask, gate.ids, gate.nids);
+                }
+            }
+        });
+    }
+}  // namespace details
+
+#endif /* SWEEP_HPP */
@@ -0,0 +1,464 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef TIME_EVOLUTION_HPP
+#define TIME_EVOLUTION_HPP
+
+#include "workspace_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Propagators computing psi <- exp(-i H t) psi for a Hermitian operator H only known through its action on a state
+// vector: apply_h(src, dst) must compute dst = H src (src and dst never alias).
+
+namespace evolution
+{
+    enum class Method
+    {
+        lanczos,    // Krylov subspace projection, adaptive step size
+        chebyshev,  // Chebyshev expansion, requires a bound on the spectral radius of H
+    };
+
+    struct Options
+    {
+        Method method = Method::lanczos;
+        unsigned krylov_dim = 16;  // maximum dimension of the Krylov subspaces
+        unsigned max_buffers = 4;  // state-sized buffers of the Lanczos propagator (at least 4, see evolve_lanczos())
+        double tol = 1.e-12;       // error tolerance per step
+    };
+
+    // State-sized buffers of a propagator, leased from a pool for the lifetime of the workspace (typically one call)
+    template <class V>
+    class Workspace
+    {
+    public:
+        explicit Workspace(memory::WorkspacePool<V>& pool) : pool_(&pool)
+        {}
+
+        void reserve(std::size_t count, std::size_t size)
+        {
+            while (buffers_.size() < count) {
+                buffers_.push_back(pool_->acquire(size));
+            }
+            for (auto& buffer: buffers_) {
+                buffer->resize(size);
+            }
+        }
+
+        V& operator[](std::size_t k)
+        {
+            return *buffers_[k];
+        }
+
+    private:
+        memory::WorkspacePool<V>* pool_;
+        std::vector<typename memory::WorkspacePool<V>::Buffer> buffers_;
+    };
+
+    namespace details
+    {
+        template <class V>
+        double norm(V const& psi)
+        {
+            double nrm = 0.;
+#pragma omp parallel for reduction(+ : nrm) schedule(static)
+            for (std::size_t i = 0; i < psi.size(); ++i) {
+                nrm += std::norm(std::complex<double>(psi[i]));
+            }
+            return std::sqrt(nrm);
+        }
+
+        // Eigen-decomposition of a real symmetric tridiagonal matrix (implicit QL with Wilkinson shifts)
+        //
+        // On entry d contains the diagonal and e the sub-diagonal (e[0] unused); on exit d contains the eigenvalues
+        // and z the eigenvectors (z[row * n + k] for eigenvalue k).
+        inline void tridiagonal_eigen(std::vector<double>& d, std::vector<double> e, std::vector<double>& z)
+        {
+            const auto n = d.size();
+            z.assign(n * n, 0.);
+            for (std::size_t k = 0; k < n; ++k) {
+                z[k * n + k] = 1.;
+            }
+            for (std::size_t k = 1; k < n; ++k) {
+                e[k - 1] = e[k];
+            }
+            if (n > 0) {
+                e[n - 1] = 0.;
+            }
+
+            for (std::size_t l = 0; l < n; ++l) {
+                for (unsigned iter = 0;; ++iter) {
+                    std::size_t m = l;
+                    for (; m + 1 < n; ++m) {
+                        const auto dd = std::abs(d[m]) + std::abs(d[m + 1]);
+                        if (std::abs(e[m]) <= std::numeric_limits<double>::epsilon() * dd) {
+                            break;
+                        }
+                    }
+                    if (m == l) {
+                        break;
+                    }
+                    if (iter == 64) {
+                        throw std::runtime_error("tridiagonal_eigen(): no convergence!");
+                    }
+                    auto g = (d[l + 1] - d[l]) / (2. * e[l]);
+                    auto r = std::hypot(g, 1.);
+                    g = d[m] - d[l] + e[l] / (g + std::copysign(r, g));
+                    double s = 1.;
+                    double c = 1.;
+                    double p = 0.;
+                    std::size_t i = m;
+                    bool underflow = false;
+                    for (; i-- > l;) {
+                        auto f = s * e[i];
+                        const auto b = c * e[i];
+                        r = std::hypot(f, g);
+                        e[i + 1] = r;
+                        if (r == 0.) {
+                            d[i + 1] -= p;
+                            e[m] = 0.;
+                            underflow = true;
+                            break;
+                        }
+                        s = f / r;
+                        c = g / r;
+                        g = d[i + 1] - p;
+                        r = (d[i] - g) * s + 2. * c * b;
+                        p = s * r;
+                        d[i + 1] = g + p;
+                        g = c * r - b;
+                        for (std::size_t k = 0; k < n; ++k) {
+                            f = z[k * n + i + 1];
+                            z[k * n + i + 1] = s * z[k * n + i] + c * f;
+                            z[k * n + i] = c * z[k * n + i] - s * f;
+                        }
+                    }
+                    if (underflow) {
+                        continue;
+                    }
+                    d[l] -= p;
+                    e[l] = g;
+                    e[m] = 0.;
+                }
+            }
+        }
+
+        // Bessel functions of the first kind J_0(x), ..., J_kmax(x) (Miller's backward recurrence)
+        inline std::vector<double> bessel_j(double x, std::size_t kmax)
+        {
+            std::vector<double> res(kmax + 1, 0.);
+            if (x == 0.) {
+                res[0] = 1.;
+                return res;
+            }
+            const auto top = std::max<std::size_t>(kmax, static_cast<std::size_t>(std::abs(x))) + 32;
+            const auto start = 2 * ((top + static_cast<std::size_t>(std::sqrt(160. * static_cast<double>(top)))) / 2);
+            double next = 0.;
+            double cur = 1.e-300;
+            double sum = 0.;
+            for (auto k = start; k > 0; --k) {
+                const auto prev = 2. * static_cast<double>(k) / x * cur - next;
+                next = cur;
+                cur = prev;
+                if (std::abs(cur) > 1.e250) {  // rescale
+                    cur *= 1.e-250;
+                    next *= 1.e-250;
+                    sum *= 1.e-250;
+                    for (auto& r: res) {
+                        r *= 1.e-250;
+                    }
+                }
+                // cur = J_{k-1}
+                if (k - 1 <= kmax) {
+                    res[k - 1] = cur;
+                }
+                if ((k - 1) % 2 == 0 && k > 1) {
+                    sum += 2. * cur;
+                }
+            }
+            sum += cur;  // J_0 + 2 sum_k J_2k = 1
+            for (auto& r: res) {
+                r /= sum;
+            }
+            return res;
+        }
+    }  // namespace details
+
+    //! Lanczos (Krylov subspace) propagator
+    /*!
+     * A Krylov subspace of dimension at most options.krylov_dim is built from psi and the exponential is computed
+     * within the subspace. The step size is chosen adaptively from the a posteriori error estimate
+     * beta * beta_m * |[exp(-i dt T_m) e_1]_m| without any additional application of H; time steps are taken until
+     * the whole evolution time is covered.
+     *
+     * If the krylov_dim + 1 basis vectors fit in options.max_buffers buffers, they are kept in the workspace.
+     * Otherwise, only the last three basis vectors are kept during the Lanczos iteration and the basis is regenerated
+     * from the recurrence coefficients in a second pass (one more application of H per basis vector), while
+     * accumulating the new state in a fourth buffer: the memory footprint does not depend on krylov_dim.
+     *
+     * Throws std::invalid_argument if options.max_buffers < 4.
+     */
+    template <class V, typename op_t>
+    void evolve_lanczos(V& psi, op_t&& apply_h, double time, Workspace<V>& ws, Options const& options)
+    {
+        using value_t = typename V::value_type;
+        if (options.max_buffers < 4) {
+            throw std::invalid_argument("evolve_lanczos(): options.max_buffers must be at least 4!");
+        }
+        const auto m = std::max(2U, options.krylov_dim);
+        const auto size = psi.size();
+        const bool store_basis = m + 1 <= options.max_buffers;
+        ws.reserve(store_basis ? m + 1 : 4, size);
+        auto basis = [&ws, store_basis](std::size_t j) -> V& { return ws[store_basis ? j : j % 3]; };
+
+        double remaining = std::abs(time);
+        const double direction = time < 0. ? -1. : 1.;
+        std::vector<double> alpha;
+        std::vector<double> beta;
+        std::vector<double> eigvals;
+        std::vector<double> eigvecs;
+        std::vector<std::complex<double>> coeffs(m);
+
+        while (remaining > 0.) {
+            const auto nrm = details::norm(psi);
+            if (nrm == 0.) {
+                return;
+            }
+
+            // Lanczos iteration
+            auto& v0 = basis(0);
+#pragma omp parallel for schedule(static)
+            for (std::size_t i = 0; i < size; ++i) {
+                v0[i] = psi[i] / static_cast<typename value_t::value_type>(nrm);
+            }
+            alpha.clear();
+            beta.assign(1, 0.);
+            bool exact = false;
+            std::size_t dim = 0;
+            for (; dim < m;) {
+                auto& v = basis(dim);
+                auto& w = basis(dim + 1);
+                apply_h(v, w);
+                double a = 0.;
+#pragma omp parallel for reduction(+ : a) schedule(static)
+                for (std::size_t i = 0; i < size; ++i) {
+                    a += std::real(std::conj(std::complex<double>(v[i])) * std::complex<double>(w[i]));
+                }
+                alpha.push_back(a);
+                ++dim;
+
+                const auto b_prev = beta.back();
+                double b = 0.;
+                const auto* v_prev = dim >= 2 ? &basis(dim - 2) : nullptr;
+#pragma omp parallel for reduction(+ : b) schedule(static)
+                for (std::size_t i = 0; i < size; ++i) {
+                    auto wi = std::complex<double>(w[i]) - a * std::complex<double>(v[i]);
+                    if (v_prev != nullptr) {
+                        wi -= b_prev * std::complex<double>((*v_prev)[i]);
+                    }
+                    w[i] = value_t(wi);
+                    b += std::norm(wi);
+                }
+                b = std::sqrt(b);
+                beta.push_back(b);
+
+                if (b <= options.tol * std::max(1., std::abs(a))) {
+                    // Invariant subspace: the projection is exact for any time step
+                    exact = true;
+                    break;
+                }
+                if (dim < m) {
+#pragma omp parallel for schedule(static)
+                    for (std::size_t i = 0; i < size; ++i) {
+                        w[i] /= static_cast<typename value_t::value_type>(b);
+                    }
+                }
+            }
+
+            // exp(-i dt T) e_1 = Z exp(-i dt Lambda) Z^T e_1
+            eigvals.assign(begin(alpha), end(alpha));
+            std::vector<double> offdiag(dim, 0.);
+            for (std::size_t k = 1; k < dim; ++k) {
+                offdiag[k] = beta[k];
+            }
+            details::tridiagonal_eigen(eigvals, offdiag, eigvecs);
+
+            auto project = [&](double dt) {
+                for (std::size_t j = 0; j < dim; ++j) {
+                    std::complex<double> c = 0.;
+                    for (std::size_t k = 0; k < dim; ++k) {
+                        c += eigvecs[j * dim + k] * eigvecs[k] * std::polar(1., -direction * dt * eigvals[k]);
+                    }
+                    coeffs[j] = c;
+                }
+            };
+
+            auto dt = remaining;
+            project(dt);
+            if (!exact) {
+                const auto b_last = beta[dim];
+                for (unsigned halvings = 0; nrm * b_last * std::abs(coeffs[dim - 1]) > options.tol; ++halvings) {
+                    if (halvings == 64) {
+                        throw std::runtime_error("evolve_lanczos(): step size underflow!");
+                    }
+                    dt /= 2.;
+                    project(dt);
+                }
+            }
+
+            // psi = nrm * V c
+            if (store_basis) {
+#pragma omp parallel for schedule(static)
+                for (std::size_t i = 0; i < size; ++i) {
+                    std::complex<double> res = 0.;
+                    for (std::size_t j = 0; j < dim; ++j) {
+                        res += coeffs[j] * std::complex<double>(ws[j][i]);
+                    }
+                    psi[i] = value_t(nrm * res);
+                }
+            }
+            else {
+                // Regenerate v_1, ..., v_{dim-1} with the coefficients of the first pass
+                auto& res = ws[3];
+                auto& v0 = basis(0);
+#pragma omp parallel for schedule(static)
+                for (std::size_t i = 0; i < size; ++i) {
+                    v0[i] = psi[i] / static_cast<typename value_t::value_type>(nrm);
+                    res[i] = value_t(coeffs[0] * std::complex<double>(v0[i]));
+                }
+                for (std::size_t j = 0; j + 1 < dim; ++j) {
+                    auto& v = basis(j);
+                    auto& w = basis(j + 1);
+                    const auto* v_prev = j >= 1 ? &basis(j - 1) : nullptr;
+                    apply_h(v, w);
+                    const auto a = alpha[j];
+                    const auto b_prev = beta[j];
+                    const auto b = beta[j + 1];
+#pragma omp parallel for schedule(static)
+                    for (std::size_t i = 0; i < size; ++i) {
+                        auto wi = std::complex<double>(w[i]) - a * std::complex<double>(v[i]);
+                        if (v_prev != nullptr) {
+                            wi -= b_prev * std::complex<double>((*v_prev)[i]);
+                        }
+                        wi /= b;
+                        w[i] = value_t(wi);
+                        res[i] = value_t(std::complex<double>(res[i]) + coeffs[j + 1] * wi);
+                    }
+                }
+#pragma omp parallel for schedule(static)
+                for (std::size_t i = 0; i < size; ++i) {
+                    psi[i] = value_t(nrm * std::complex<double>(res[i]));
+                }
+            }
+            remaining = dt == remaining ? 0. : remaining - dt;
+        }
+    }
+
+    //! Chebyshev propagator
+    /*!
+     * exp(-i H t) = J_0(R t) + 2 sum_k (-i)^k J_k(R t) T_k(H / R), where R >= ||H|| (e.g. the sum of the absolute
+     * values of the coefficients of a Pauli sum). The series is truncated once |J_k(R t)| drops below the tolerance;
+     * the evolution is split into steps with R dt <= max_arg to keep the recurrence well conditioned. Uses 4 buffers of
+     * the workspace.
+     */
+    template <class V, typename op_t>
+    void evolve_chebyshev(V& psi, op_t&& apply_h, double time, double radius, Workspace<V>& ws,
+                          Options const& options)
+    {
+        using value_t = typename V::value_type;
+        constexpr double max_arg = 32.;
+        if (radius <= 0.) {
+            return;
+        }
+
+        const auto size = psi.size();
+        ws.reserve(4, size);
+        const auto num_steps = static_cast<std::size_t>(std::ceil(std::abs(time) * radius / max_arg));
+        const auto dt = num_steps == 0 ? 0. : time / static_cast<double>(num_steps);
+        const auto x = std::abs(dt) * radius;
+
+        // Expansion coefficients a_k = (2 - delta_k0) (-i)^k J_k(R dt), truncated
+        const auto bessel = details::bessel_j(x, static_cast<std::size_t>(x) + 128);
+        std::size_t order = bessel.size();
+        while (order > static_cast<std::size_t>(x) + 1 && std::abs(bessel[order - 1]) < options.tol) {
+            --order;
+        }
+        std::vector<std::complex<double>> a(order);
+        const std::complex<double> mi(0., dt < 0. ? 1. : -1.);
+        std::complex<double> power = 1.;
+        for (std::size_t k = 0; k < order; ++k, power *= mi) {
+            a[k] = (k == 0 ? 1. : 2.) * power * bessel[k];
+        }
+
+        auto* prev = &ws[0];
+        auto* cur = &ws[1];
+        auto* next = &ws[2];
+        auto& res = ws[3];
+        const auto scale = 1. / radius;
+        for (std::size_t step = 0; step < num_steps; ++step) {
+            // T_0 psi = psi, T_1 psi = H' psi
+#pragma omp parallel for schedule(static)
+            for (std::size_t i = 0; i < size; ++i) {
+                (*prev)[i] = psi[i];
+            }
+            apply_h(*prev, *cur);
+#pragma omp parallel for schedule(static)
+            for (std::size_t i = 0; i < size; ++i) {
+                const auto t1 = scale * std::complex<double>((*cur)[i]);
+                (*cur)[i] = value_t(t1);
+                res[i] = value_t(a[0] * std::complex<double>(psi[i]) + (order > 1 ? a[1] * t1 : 0.));
+            }
+            // T_{k+1} = 2 H' T_k - T_{k-1}
+            for (std::size_t k = 2; k < order; ++k) {
+                apply_h(*cur, *next);
+#pragma omp parallel for schedule(static)
+                for (std::size_t i = 0; i < size; ++i) {
+                    const auto t = 2. * scale * std::complex<double>((*next)[i]) - std::complex<double>((*prev)[i]);
+                    (*next)[i] = value_t(t);
+                    res[i] = value_t(std::complex<double>(res[i]) + a[k] * t);
+                }
+                std::swap(prev, cur);
+                std::swap(cur, next);
+            }
+#pragma omp parallel for schedule(static)
+            for (std::size_t i = 0; i < size; ++i) {
+                psi[i] = res[i];
+            }
+        }
+    }
+
+    //! Compute psi <- exp(-i H t) psi with the method selected in the options
+    /*!
+     * \param radius Upper bound on the spectral radius of H (only used by the Chebyshev propagator)
+     */
+    template <class V, typename op_t>
+    void evolve(V& psi, op_t&& apply_h, double time, double radius, Workspace<V>& ws, Options const& options)
+    {
+        if (options.method == Method::chebyshev) {
+            evolve_chebyshev(psi, std::forward<op_t>(apply_h), time, radius, ws, options);
+        }
+        else {
+            evolve_lanczos(psi, std::forward<op_t>(apply_h), time, ws, options);
+        }
+    }
+}  // namespace evolution
+
+#endif /* TIME_EVOLUTION_HPP */
@@ -142,6 +142,76 @@ namespace utils
     {
         return make_hermitian_array_impl(m, std::make_index_sequence<N>{});
     }
+
+#    if defined(__AVX2__)
+    // Four single-precision complex numbers per register for the single-precision kernels
+    using intrin_float_t = __m256;
+
+    template <std::size_t N>
+    struct intrin_float_array
+    {
+        using value_type = intrin_float_t;
+        using size_type = std::size_t;
+
+        constexpr value_type& operator[](size_type n) noexcept
+        {
+            return data_[n];
+        }
+
+        constexpr const value_type& operator[](size_type n) const noexcept
+        {
+            return data_[n];
+        }
+
+        intrin_float_t data_[N];
+    };
+
+    template <std::size_t N>
+    auto make_hermitian_array(const intrin_float_array<N>& m)
+    {
+        const auto negf = _mm256_setr_ps(1.F, -1.F, 1.F, -1.F, 1.F, -1.F, 1.F, -1.F);
+        intrin_float_array<N> mt;
+        for (std::size_t i = 0; i < N; ++i) {
+            mt[i] = _mm256_mul_ps(_mm256_permute_ps(m[i], 0xB1), negf);
+        }
+        return mt;
+    }
+#    endif  // __AVX2__
+
+#    if defined(__AVX512F__)
+    // Four complex numbers per register for the AVX-512 kernels
+    using intrin512_t = __m512d;
+
+    template <std::size_t N>
+    struct intrin512_array
+    {
+        using value_type = intrin512_t;
+        using size_type = std::size_t;
+
+        constexpr value_type& operator[](size_type n) noexcept
+        {
+            return data_[n];
+        }
+
+        constexpr const value_type& operator[](size_type n) const noexcept
+        {
+            return data_[n];
+        }
+
+        intrin512_t data_[N];
+    };
+
+    template <std::size_t N>
+    auto make_hermitian_array(const intrin512_array<N>& m)
+    {
+        const auto neg512 = _mm512_setr_pd(1., -1., 1., -1., 1., -1., 1., -1.);
+        intrin512_array<N> mt;
+        for (std::size_t i = 0; i < N; ++i) {
+            mt[i] = _mm512_mul_pd(_mm512_permute_pd(m[i], 0x55), neg512);
+        }
+        return mt;
+    }
+#    endif  // __AVX512F__
 #endif  // INTRIN
 }  // namespace utils
 #endif /* TO_ARRAY_HPP */
@@ -25,11 +25,19 @@
 namespace types
 {
     static constexpr auto alignment = 512;
+
+    template <typename calc_t>
+    using basic_state_vector = std::vector<std::complex<calc_t>, aligned_allocator<std::complex<calc_t>, alignment>>;
+
     using calc_type = double;
     using complex_type = std::complex<calc_type>;
-    using StateVector = std::vector<complex_type, aligned_allocator<complex_type, alignment>>;
+    using StateVector = basic_state_vector<calc_type>;
+
+    // Single-precision state vector (gate matrices are always kept in double precision)
+    using StateVectorFloat = basic_state_vector<float>;
 
     using V = StateVector;
+    using VF = StateVectorFloat;
     using M = fusion::Fusion::Matrix;
     using UINT = std::size_t;
 }  // namespace types
@@ -0,0 +1,130 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef WORKSPACE_POOL_HPP
+#define WORKSPACE_POOL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace memory
+{
+    // Pool of state-sized scratch buffers owned by a single simulator
+    //
+    // A buffer is leased with acquire() and automatically returned to the pool when the lease goes out of scope. The
+    // content of the leased vector may be swapped with another vector (e.g. the state vector) in the meantime, in
+    // which case the memory of the other vector is recycled instead. Only the largest max_free buffers are kept.
+    //
+    // NB: the pool must outlive all of its leases; a pool is not thread-safe and is meant to be used by a single
+    //     simulator (one simulator per thread).
+    template <class V>
+    class WorkspacePool
+    {
+    public:
+        static constexpr std::size_t default_max_free = 2;
+
+        class Buffer
+        {
+        public:
+            Buffer(WorkspacePool* pool, V&& vec) : pool_(pool), vec_(std::move(vec))
+            {}
+            Buffer(Buffer&& other) noexcept : pool_(std::exchange(other.pool_, nullptr)), vec_(std::move(other.vec_))
+            {}
+            Buffer(Buffer const&) = delete;
+            Buffer& operator=(Buffer const&) = delete;
+            Buffer& operator=(Buffer&&) = delete;
+
+            ~Buffer()
+            {
+                if (pool_ != nullptr) {
+                    pool_->recycle(std::move(vec_));
+                }
+            }
+
+            V& operator*()
+            {
+                return vec_;
+            }
+            V* operator->()
+            {
+                return &vec_;
+            }
+
+        private:
+            WorkspacePool* pool_;
+            V vec_;
+        };
+
+        explicit WorkspacePool(std::size_t max_free = default_max_free) : max_free_(max_free)
+        {}
+
+        //! Lease a buffer of the given size (content unspecified)
+        /*!
+         * The smallest free buffer that is large enough is reused; otherwise new memory is allocated (see
+         * aligned_allocator for the NUMA-aware placement of large allocations).
+         */
+        [[nodiscard]] Buffer acquire(std::size_t size)
+        {
+            auto best = end(free_);
+            for (auto it = begin(free_); it != end(free_); ++it) {
+                if (it->capacity() >= size && (best == end(free_) || it->capacity() < best->capacity())) {
+                    best = it;
+                }
+            }
+
+            V vec;
+            if (best != end(free_)) {
+                vec = std::move(*best);
+                free_.erase(best);
+            }
+            vec.resize(size);
+            return Buffer(this, std::move(vec));
+        }
+
+        //! Give some memory to the pool (e.g. a state vector that is no longer needed)
+        void recycle(V&& vec)
+        {
+            if (vec.capacity() == 0 || max_free_ == 0) {
+                return;
+            }
+            free_.push_back(std::move(vec));
+            if (free_.size() > max_free_) {
+                // Drop the smallest buffer
+                auto smallest = std::min_element(begin(free_), end(free_), [](V const& lhs, V const& rhs) {
+                    return lhs.capacity() < rhs.capacity();
+                });
+                free_.erase(smallest);
+            }
+        }
+
+        //! Release all the free buffers
+        void clear()
+        {
+            free_.clear();
+        }
+
+        [[nodiscard]] std::size_t num_free() const
+        {
+            return free_.size();
+        }
+
+    private:
+        std::size_t max_free_;
+        std::vector<V> free_;
+    };
+}  // namespace memory
+
+#endif /* WORKSPACE_POOL_HPP */
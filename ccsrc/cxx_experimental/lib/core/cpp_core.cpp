@@ -14,7 +14,11 @@
 
 #include "core/cpp_core.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
 #include <type_traits>
 
 #include <tweedledum/Operators/Ising.h>
@@ -22,6 +26,10 @@
 #include <tweedledum/Passes/Optimization/gate_cancellation.h>
 #include <tweedledum/Passes/Optimization/phase_folding.h>
 
+#include <symengine/basic.h>
+#include <symengine/derivative.h>
+#include <symengine/symbol.h>
+
 #include "cengines/write_projectq.hpp"
 #include "mapping/types.hpp"
 #include "ops/gates/allocate.hpp"
@@ -29,6 +37,7 @@
 #include "ops/gates/measure.hpp"
 #include "ops/gates/ph.hpp"
 #include "ops/gates/sqrtswap.hpp"
+#include "ops/parametric/angle_gates.hpp"
 
 // #define MEASURE_TIMINGS
 #ifdef MEASURE_TIMINGS
@@ -36,7 +45,92 @@
 #endif  // MEASURE_TIMINGS
 
 namespace mindquantum::core {
-CppCore::CppCore() : simulator_backend_(false), has_new_operations_(false), sim_(nullptr), output_stream(&(std::cout)) {
+namespace {
+auto to_fusion_gate(const CppCore::MatrixType& matrix, const std::vector<qubit_id_t>& target_ids,
+                    const std::vector<qubit_id_t>& control_ids) {
+    fusion::Gate gate;
+    for (const auto& row : matrix) {
+        gate.matrix.insert(std::end(gate.matrix), std::begin(row), std::end(row));
+    }
+    std::transform(std::begin(target_ids), std::end(target_ids), std::back_inserter(gate.targets),
+                   [](const auto& id) { return static_cast<fusion::Gate::IndexVector::value_type>(id); });
+    std::transform(std::begin(control_ids), std::end(control_ids), std::back_inserter(gate.controls),
+                   [](const auto& id) { return static_cast<fusion::Gate::IndexVector::value_type>(id); });
+    return gate;
+}
+
+//! Flatten a (tweedledum) gate matrix in row-major order
+template <typename matrix_t>
+auto to_adjoint_matrix(const matrix_t& matrix) {
+    const auto dim = static_cast<std::size_t>(matrix.rows());
+    adjoint::Gate::Matrix res;
+    res.reserve(dim * dim);
+    for (auto i(0UL); i < dim; ++i) {
+        for (auto j(0UL); j < dim; ++j) {
+            res.emplace_back(matrix(i, j));
+        }
+    }
+    return res;
+}
+
+//! Numerical matrix of a parametric angle gate and its derivative with respect to the angle
+template <typename gate_t>
+auto eval_with_derivative(const gate_t& gate, const ops::parametric::subs_map_t& subs) {
+    using non_param_t = typename gate_t::non_param_type;
+    constexpr auto pi = 3.1415926535897932;
+
+    const auto angle = gate.eval_full(subs).angle();
+    auto matrix = to_adjoint_matrix(non_param_t{angle}.matrix());
+    if constexpr (std::is_same_v<gate_t, ops::parametric::Ph>) {
+        // d/dtheta exp(i theta) = exp(i (theta + pi/2))
+        return std::make_pair(std::move(matrix), to_adjoint_matrix(non_param_t{angle + pi / 2}.matrix()));
+    } else if constexpr (std::is_same_v<gate_t, ops::parametric::P>) {
+        // d/dtheta diag(1, exp(i theta)) = diag(0, exp(i (theta + pi/2)))
+        auto derivative = to_adjoint_matrix(non_param_t{angle + pi / 2}.matrix());
+        derivative[0] = 0.;
+        return std::make_pair(std::move(matrix), std::move(derivative));
+    } else {
+        // Rotations exp(-i theta/2 P) with P^2 = 1: d/dtheta U(theta) = -i/2 P U(theta) = U(theta + pi) / 2
+        auto derivative = to_adjoint_matrix(non_param_t{angle + pi}.matrix());
+        for (auto& el : derivative) {
+            el *= 0.5;
+        }
+        return std::make_pair(std::move(matrix), std::move(derivative));
+    }
+}
+
+//! Convert a parametric angle gate, applying the chain rule for each of the parameters its angle depends on
+template <typename gate_t>
+void to_adjoint_gate(const gate_t& gate, const ops::parametric::param_list_t& params,
+                     const ops::parametric::subs_map_t& subs, adjoint::Gate& result) {
+    auto [matrix, derivative] = eval_with_derivative(gate, subs);
+    result.matrix = std::move(matrix);
+    for (auto k(0UL); k < std::size(params); ++k) {
+        if (!SymEngine::is_a<SymEngine::Symbol>(*params[k])) {
+            throw std::invalid_argument("Adjoint gradient: can only differentiate with respect to symbols!");
+        }
+        const auto symbol = SymEngine::rcp_static_cast<const SymEngine::Symbol>(params[k]);
+        const auto dtheta = SymEngine::diff(gate.param(0), symbol);
+        if (SymEngine::eq(*dtheta, *SymEngine::zero)) {
+            continue;
+        }
+        const auto weight = ops::parametric::real::theta::param_type::eval(dtheta->subs(subs));
+        auto d = derivative;
+        for (auto& el : d) {
+            el *= weight;
+        }
+        result.derivatives.emplace_back(k, std::move(d));
+    }
+}
+}  // namespace
+
+CppCore::CppCore()
+    : simulator_backend_(false)
+    , has_new_operations_(false)
+    , deferred_execution_(true)
+    , kernel_launches_(0)
+    , sim_(nullptr)
+    , output_stream(&(std::cout)) {
 }
 
 void CppCore::allocate_qubit(unsigned id) {
@@ -75,6 +169,21 @@ void CppCore::set_simulator_backend(::projectq::Simulator& sim) {
     simulator_backend_ = true;
 }
 
+void CppCore::set_deferred_execution(bool deferred) {
+    deferred_execution_ = deferred;
+}
+
+void CppCore::set_fusion_planner(unsigned max_qubits) {
+    if (max_qubits == 0) {
+        fusion_planner_.reset();
+        return;
+    }
+    if (max_qubits > ::projectq::Simulator::max_fusion_qubits()) {
+        throw std::invalid_argument("Fusion planner: maximum number of qubits per block exceeds simulator limit!");
+    }
+    fusion_planner_.emplace(max_qubits);
+}
+
 void CppCore::apply_command(const ops::Command& cmd) {
     has_new_operations_ = true;
     apply_operation_(cmd.get_gate(), cmd.get_control_qubits(), cmd.get_qubits());
@@ -87,10 +196,23 @@ void CppCore::flush() {
 
     traverse_engine_list();
 
+    kernel_launches_ = 0;
     if (sim_backend()) {  // Only simulate if there is a simulator backend
+        const auto kernel_launches_start = sim_->get_kernel_launches();
         std::vector<qubit_id_t> target_ids;
         std::vector<qubit_id_t> control_ids;
         MatrixType gate_matrix;
+        fusion::FusionPlanner::GateVector pending_gates;
+
+        // Apply all the gates that have not yet been applied to the state vector
+        const auto apply_pending_gates = [&]() {
+            if (fusion_planner_ && !std::empty(pending_gates)) {
+                auto blocks = fusion_planner_->plan(pending_gates);
+                sim_->apply_fused_blocks(blocks);
+                pending_gates.clear();
+            }
+            sim_->run();
+        };
 
 #ifdef MEASURE_TIMINGS
         std::vector<std::pair<std::string, unsigned>> kinds;
@@ -123,6 +245,7 @@ void CppCore::flush() {
 #endif  // MEASURE_TIMINGS
 
                 if (inst.is_one<ops::Measure>()) {
+                    apply_pending_gates();
                     const auto measure_results = sim_->measure_qubits_return(target_ids);
                     for (auto i(0UL); i < std::size(target_ids); ++i) {
                         measure_info_.insert({target_ids.at(i), measure_results.at(i)});
@@ -145,16 +268,16 @@ void CppCore::flush() {
                 } else if (inst.is_one<ops::QubitOperator>()) {
                     const auto& qubit_op = inst.cast<ops::QubitOperator>();
                     assert(std::empty(control_ids));
-                    std::vector<ops::QubitOperator::ComplexTerm> terms;
-                    std::copy(std::begin(qubit_op.get_terms()), std::end(qubit_op.get_terms()),
-                              std::back_inserter(terms));
-                    sim_->apply_qubit_operator(terms, target_ids);
+                    const auto op = sim_->compile_terms(qubit_op.get_terms());
+                    apply_pending_gates();
+                    sim_->apply_qubit_operator(op, target_ids);
+                    return;
                 } else if (inst.is_one<ops::TimeEvolution>()) {
                     const auto& time_evol = inst.cast<ops::TimeEvolution>();
-                    std::vector<ops::QubitOperator::ComplexTerm> terms;
-                    std::copy(std::begin(time_evol.get_hamiltonian().get_terms()),
-                              std::end(time_evol.get_hamiltonian().get_terms()), std::back_inserter(terms));
-                    sim_->emulate_time_evolution(terms, time_evol.get_time(), target_ids, control_ids);
+                    const auto op = sim_->compile_terms(time_evol.get_hamiltonian().get_terms());
+                    apply_pending_gates();
+                    sim_->emulate_time_evolution(op, time_evol.get_time(), target_ids, control_ids);
+                    return;
                 } else {
                     std::cerr << "Simulator doesn't support gate type:\n";
                     std::cerr << inst.kind() << std::endl;
@@ -171,8 +294,17 @@ void CppCore::flush() {
                 if (std::empty(gate_matrix)) {
                     std::cerr << "Error: Empty gate used in simulator" << std::endl;
                 }
-                sim_->apply_controlled_gate(gate_matrix, target_ids, control_ids);
-                sim_->run();
+                // With the fusion planner, gates are fused by blocks before the next synchronisation point.
+                // In deferred mode, the simulator decides by itself when the fused gates need to be applied
+                // (based on the fusion qubit limits). Otherwise, execute each gate immediately.
+                if (fusion_planner_) {
+                    pending_gates.emplace_back(to_fusion_gate(gate_matrix, target_ids, control_ids));
+                } else {
+                    sim_->apply_controlled_gate(gate_matrix, target_ids, control_ids);
+                    if (!deferred_execution_) {
+                        sim_->run();
+                    }
+                }
 
 #ifdef MEASURE_TIMINGS
                 sims.emplace_back(std::chrono::steady_clock::now());
@@ -195,19 +327,13 @@ void CppCore::flush() {
 #endif  // MEASURE_TIMINGS
 
         // Force flush
-        sim_->run();
+        apply_pending_gates();
+
+        kernel_launches_ = sim_->get_kernel_launches() - kernel_launches_start;
     }
 
     circuit_manager_.commit_changes();
-
-    // Deallocate
-    for (const auto& id : deallocations_) {
-        if (sim_backend()) {
-            sim_->deallocate_qubit(qubit_id_t(id));
-        }
-    }
-    circuit_manager_.delete_qubits(deallocations_);
-    deallocations_.clear();
+    apply_deallocations_();
 
     has_new_operations_ = false;
 }
@@ -279,6 +405,69 @@ std::map<unsigned, bool> CppCore::get_measure_info() {
     return tmp_info_;
 }
 
+adjoint::Result CppCore::get_expectation_with_gradient(const ops::QubitOperator& hamiltonian,
+                                                       const std::vector<qubit_id_t>& qubit_ids,
+                                                       const ops::parametric::param_list_t& params,
+                                                       const ops::parametric::subs_map_t& subs) {
+    if (!sim_backend()) {
+        throw std::runtime_error("get_expectation_with_gradient(): no simulator backend!");
+    }
+
+    traverse_engine_list();
+
+    // NB: the gates are applied to the state vector in order, the adjoint method then walks the circuit backwards
+    std::vector<adjoint::Gate> circuit;
+    circuit_manager_.foreach_instruction(
+        [&](const instruction_t& inst) {
+            auto& gate = circuit.emplace_back();
+            inst.foreach_control([&](const auto& control) {
+                gate.ctrls.emplace_back(qubit_id_t(circuit_manager_.translate_id(control)));
+            });
+            inst.foreach_target([&](const auto& target) {
+                gate.ids.emplace_back(qubit_id_t(circuit_manager_.translate_id(target)));
+            });
+
+            namespace param = ops::parametric;
+            if (inst.is_one<param::Rx>()) {
+                to_adjoint_gate(inst.cast<param::Rx>(), params, subs, gate);
+            } else if (inst.is_one<param::Ry>()) {
+                to_adjoint_gate(inst.cast<param::Ry>(), params, subs, gate);
+            } else if (inst.is_one<param::Rz>()) {
+                to_adjoint_gate(inst.cast<param::Rz>(), params, subs, gate);
+            } else if (inst.is_one<param::Rxx>()) {
+                to_adjoint_gate(inst.cast<param::Rxx>(), params, subs, gate);
+            } else if (inst.is_one<param::Ryy>()) {
+                to_adjoint_gate(inst.cast<param::Ryy>(), params, subs, gate);
+            } else if (inst.is_one<param::Rzz>()) {
+                to_adjoint_gate(inst.cast<param::Rzz>(), params, subs, gate);
+            } else if (inst.is_one<param::P>()) {
+                to_adjoint_gate(inst.cast<param::P>(), params, subs, gate);
+            } else if (inst.is_one<param::Ph>()) {
+                to_adjoint_gate(inst.cast<param::Ph>(), params, subs, gate);
+            } else if (inst.is_one<td::Op::X, td::Op::Y, td::Op::Z, td::Op::S, td::Op::Sdg, td::Op::T, td::Op::Tdg,
+                                   td::Op::P, td::Op::H, td::Op::Rx, td::Op::Ry, td::Op::Rz, td::Op::Sx, ops::Ph,
+                                   td::Op::Swap, td::Op::Rxx, td::Op::Ryy, td::Op::Rzz, ops::SqrtSwap>()) {
+                gate.matrix = to_adjoint_matrix(inst.matrix().value());
+            } else {
+                throw std::runtime_error("get_expectation_with_gradient(): unsupported gate type "
+                                         + std::string(inst.kind()));
+            }
+        },
+        uncommitted);
+
+    for (const auto& gate : circuit) {
+        sim_->apply_controlled_gate(gate.matrix, gate.ids, gate.ctrls);
+    }
+    auto result = sim_->get_expectation_with_gradient(sim_->compile_terms(hamiltonian.get_terms()), qubit_ids,
+                                                      circuit, std::size(params));
+
+    circuit_manager_.commit_changes();
+    apply_deallocations_();
+
+    has_new_operations_ = false;
+    return result;
+}
+
 void CppCore::set_output_stream(std::string_view file_name) {
     if (filestream.is_open()) {
         filestream.close();
@@ -299,6 +488,16 @@ void CppCore::write(std::string_view format) {
     }
 }
 
+void CppCore::apply_deallocations_() {
+    for (const auto& id : deallocations_) {
+        if (sim_backend()) {
+            sim_->deallocate_qubit(qubit_id_t(id));
+        }
+    }
+    circuit_manager_.delete_qubits(deallocations_);
+    deallocations_.clear();
+}
+
 void CppCore::apply_operation_(const gate_t& gate, const qureg_t& control_qubit_ids, const qureg_t& qubit_ids) {
     using ext_id_t = decltype(circuit_manager_)::ext_id_t;
 
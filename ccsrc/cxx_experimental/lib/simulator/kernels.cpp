@@ -21,6 +21,8 @@
 #include "kernel3.hpp"
 #include "kernel4.hpp"
 #include "kernel5.hpp"
+#include "structured_kernels.hpp"
+#include "sweep.hpp"
 #include "types.hpp"
 
 #include <pybind11/pybind11.h>
@@ -42,18 +44,94 @@ static const std::array<std::array<Kernel<V, M, UINT>, 2>, 5> kernels{
 using types::M;
 using types::UINT;
 using types::V;
+using types::VF;
+
+template <class V>
+static void apply_kernel(V& psi, M const& m, UINT ctrlmask, fusion::Fusion::IndexVector const& ids, unsigned nids)
+{
+    // NOLINTNEXTLINE
+    kernels<V, M, UINT>[nids - 1][ctrlmask == 0 ? 0 : 1](psi, m, ctrlmask, &ids[0]);
+}
+
+template <class V>
+static void apply_sweep(V& psi, fusion::FusedGate const* gates, std::size_t ngates, unsigned tile_qubits)
+{
+    using view_t = details::state_view<typename V::value_type>;
+    details::sweep(
+        psi, gates, ngates, tile_qubits,
+        [](view_t& view, M const& m, UINT ctrlmask, fusion::Fusion::IndexVector const& ids, unsigned nids) {
+            // NOLINTNEXTLINE
+            kernels<view_t, M, UINT>[nids - 1][ctrlmask == 0 ? 0 : 1](view, m, ctrlmask, &ids[0]);
+        },
+        [](view_t& view, fusion::StructuredGate const& gate, UINT ctrlmask, fusion::Fusion::IndexVector const& ids,
+           unsigned nids) { details::kernel_structured(view, gate, ctrlmask, &ids[0], nids); });
+}
 
 extern "C" void kernel(V& psi, M const& m, UINT ctrlmask, fusion::Fusion::IndexVector const& ids, unsigned nids)
 {
     debug::printf("kernel%d\n", static_cast<int>(nids));
 
-    // NOLINTNEXTLINE
-    kernels<V, M, UINT>[nids - 1][ctrlmask == 0 ? 0 : 1](psi, m, ctrlmask, &ids[0]);
+    apply_kernel(psi, m, ctrlmask, ids, nids);
+}
+
+#ifndef HIQ_WITH_CUDA
+extern "C" void kernel_structured(V& psi, fusion::StructuredGate const& gate, UINT ctrlmask,
+                                  fusion::Fusion::IndexVector const& ids, unsigned nids)
+{
+    debug::printf("kernel_structured%d (kind = %d)\n", static_cast<int>(nids), static_cast<int>(gate.kind));
+
+    details::kernel_structured(psi, gate, ctrlmask, &ids[0], nids);
+}
+
+extern "C" void kernel_sweep(V& psi, fusion::FusedGate const* gates, std::size_t ngates, unsigned tile_qubits)
+{
+    debug::printf("kernel_sweep (%zu gates, %u tile qubits)\n", ngates, tile_qubits);
+
+    apply_sweep(psi, gates, ngates, tile_qubits);
+}
+
+// Single-precision state vectors (the gate matrices are still given in double precision)
+//
+// NB: the vector kernels only have a single-precision variant for AVX2
+#    if !defined(INTRIN) || defined(NOINTRIN) || defined(__AVX2__)
+#        define HAS_SINGLE_PRECISION_KERNELS
+extern "C" void kernel_float(VF& psi, M const& m, UINT ctrlmask, fusion::Fusion::IndexVector const& ids,
+                             unsigned nids)
+{
+    debug::printf("kernel_float%d\n", static_cast<int>(nids));
+
+    apply_kernel(psi, m, ctrlmask, ids, nids);
+}
+
+extern "C" void kernel_structured_float(VF& psi, fusion::StructuredGate const& gate, UINT ctrlmask,
+                                        fusion::Fusion::IndexVector const& ids, unsigned nids)
+{
+    debug::printf("kernel_structured_float%d (kind = %d)\n", static_cast<int>(nids), static_cast<int>(gate.kind));
+
+    details::kernel_structured(psi, gate, ctrlmask, &ids[0], nids);
+}
+
+extern "C" void kernel_sweep_float(VF& psi, fusion::FusedGate const* gates, std::size_t ngates, unsigned tile_qubits)
+{
+    debug::printf("kernel_sweep_float (%zu gates, %u tile qubits)\n", ngates, tile_qubits);
+
+    apply_sweep(psi, gates, ngates, tile_qubits);
 }
+#    endif  // !INTRIN || NOINTRIN || __AVX2__
+#endif      // !HIQ_WITH_CUDA
 
 // NOLINTNEXTLINE
 PYBIND11_MODULE(MODULE_NAME, m)
 {
     m.doc() = "C++ simulator backend specialization for ProjectQ";
     m.def("kernel", []() { return reinterpret_cast<void*>(&kernel); });  // NOLINT
+#ifndef HIQ_WITH_CUDA
+    m.def("kernel_structured", []() { return reinterpret_cast<void*>(&kernel_structured); });  // NOLINT
+    m.def("kernel_sweep", []() { return reinterpret_cast<void*>(&kernel_sweep); });            // NOLINT
+#    ifdef HAS_SINGLE_PRECISION_KERNELS
+    m.def("kernel_float", []() { return reinterpret_cast<void*>(&kernel_float); });                        // NOLINT
+    m.def("kernel_structured_float", []() { return reinterpret_cast<void*>(&kernel_structured_float); });  // NOLINT
+    m.def("kernel_sweep_float", []() { return reinterpret_cast<void*>(&kernel_sweep_float); });            // NOLINT
+#    endif  // HAS_SINGLE_PRECISION_KERNELS
+#endif  // !HIQ_WITH_CUDA
 }
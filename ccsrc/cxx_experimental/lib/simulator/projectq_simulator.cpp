@@ -16,6 +16,8 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <variant>
+#include <vector>
 
 #include "core/types.hpp"
 #include "ops/gates.hpp"
@@ -24,21 +26,35 @@
 
 namespace mindquantum::simulation::projectq {
 
-Simulator::Simulator(uint32_t seed) : base_t{seed} {
+namespace {
+// NB: the simulators are neither copyable nor movable, the variant is constructed in place (guaranteed copy elision)
+std::variant<::Simulator, ::SimulatorFloat> make_simulator(uint32_t seed, Simulator::precision_t precision) {
+    if (precision == Simulator::precision_t::fp32) {
+        return std::variant<::Simulator, ::SimulatorFloat>{std::in_place_type<::SimulatorFloat>, seed};
+    }
+    return std::variant<::Simulator, ::SimulatorFloat>{std::in_place_type<::Simulator>, seed};
+}
+}  // namespace
+
+Simulator::Simulator(uint32_t seed, precision_t precision) : base_t{seed}, sim_{make_simulator(seed, precision)} {
 }
 
 // =============================================================================
 
 bool Simulator::has_qubit(const qubit_t& qubit) const {
-    return sim_.has_qubit(qubit_id_t{qubit});
+    return std::visit([&qubit](const auto& sim) { return sim.has_qubit(qubit_id_t{qubit}); }, sim_);
 }
 
 bool Simulator::allocate_qubits(const qubits_t& qubits) {
+    // NB: repeated qubits are only allocated once (BasicSimulator::allocate_qubits() rejects duplicate ids)
+    std::vector<unsigned> ids;
     for (const auto& qubit : qubits) {
-        if (!has_qubit(qubit)) {
-            sim_.allocate_qubit(qubit_id_t{qubit});
+        const auto id = qubit_id_t{qubit};
+        if (!has_qubit(qubit) && std::find(begin(ids), end(ids), id) == end(ids)) {
+            ids.emplace_back(id);
         }
     }
+    visit([&ids](auto& sim) { sim.allocate_qubits(ids); });
     return true;
 }
 
@@ -61,7 +77,7 @@ bool Simulator::run_instruction(const instruction_t& inst) {
             qubits.emplace_back(qubit_id_t{qubit});
         }
         std::vector<bool> res;
-        sim_.measure_qubits(qubits, res);
+        visit([&qubits, &res](auto& sim) { sim.measure_qubits(qubits, res); });
         return true;
     } else if (inst.is_one<ops::X, ops::Y, ops::Z, ops::S, ops::Sdg, ops::T, ops::Tdg, ops::P, ops::H, ops::Rx, ops::Ry,
                            ops::Rz, ops::Sx, ops::Ph>()) {
@@ -86,8 +102,10 @@ bool Simulator::run_instruction(const instruction_t& inst) {
         return false;
     }
 
-    sim_.apply_controlled_gate(gate_matrix, target_ids, control_ids);
-    sim_.run();
+    visit([&](auto& sim) {
+        sim.apply_controlled_gate(gate_matrix, target_ids, control_ids);
+        sim.run();
+    });
 
     return true;
 }
@@ -46,6 +46,12 @@ backends::SimBackend backends::SimBackendGetEnv()
     if (env == "VECTOR_THREADED") {
         return SimBackend::VectorThreaded;
     }
+    if (env == "VECTOR_AVX512_SERIAL") {
+        return SimBackend::VectorAVX512Serial;
+    }
+    if (env == "VECTOR_AVX512_THREADED") {
+        return SimBackend::VectorAVX512Threaded;
+    }
     if (env == "OFFLOAD_NVIDIA") {
         return SimBackend::OffloadNVIDIA;
     }
@@ -65,6 +71,11 @@ backends::SimBackend backends::SimBackendGetAuto()
         return SimBackend::OffloadNVIDIA;
     }
 
+    // If AVX-512 is available, select SimBackend::VectorAVX512Threaded
+    if (SimBackendIsAvailable(SimBackend::VectorAVX512Threaded)) {
+        return SimBackend::VectorAVX512Threaded;
+    }
+
     // If AVX2 is available, select SimBackend::VectorThreaded
     if (SimBackendIsAvailable(SimBackend::VectorThreaded)) {
         return SimBackend::VectorThreaded;
@@ -84,6 +95,13 @@ bool backends::SimBackendIsSupported(SimBackend backend)
         case SimBackend::VectorSerial:
         case SimBackend::VectorThreaded:
             return isSupported(agner::InstrSet::AVX2);
+        case SimBackend::VectorAVX512Serial:
+        case SimBackend::VectorAVX512Threaded:
+#ifdef HIQ_WITH_AVX512
+            return isSupported(agner::InstrSet::AVX512F);
+#else
+            return false;
+#endif
         case SimBackend::OffloadNVIDIA:
 #ifdef HIQ_WITH_CUDA
             return true;
@@ -133,6 +151,20 @@ pybind11::module_ backends::SimBackendAcquire(SimBackend backend)  // NOLINT(mis
         case SimBackend::VectorThreaded:
             backendName = "_cppsim_vector_threaded";
             break;
+        case SimBackend::VectorAVX512Serial:
+#ifdef HIQ_WITH_AVX512
+            backendName = "_cppsim_vector_avx512_serial";
+#else
+            throw pybind11::value_error("Python module was not compiled with AVX-512 support enabled!");
+#endif
+            break;
+        case SimBackend::VectorAVX512Threaded:
+#ifdef HIQ_WITH_AVX512
+            backendName = "_cppsim_vector_avx512_threaded";
+#else
+            throw pybind11::value_error("Python module was not compiled with AVX-512 support enabled!");
+#endif
+            break;
         case SimBackend::OffloadNVIDIA:
 #ifdef HIQ_WITH_CUDA
             backendName = "_cppsim_offload_nvidia";
@@ -16,59 +16,187 @@
 
 #include "simbackends.hpp"
 
-Simulator::Simulator(unsigned seed)
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+template <typename calc_t>
+BasicSimulator<calc_t>::BasicSimulator(unsigned seed) : BasicSimulator(seed, nullptr)
+{
+    select_backend(backends::SimBackendGetEnv());
+}
+
+template <typename calc_t>
+BasicSimulator<calc_t>::BasicSimulator(unsigned seed, backend_kernel_t* kernel,
+                                       backend_structured_kernel_t* structured_kernel,
+                                       backend_sweep_kernel_t* sweep_kernel)
     : N_(0)
     , vec_(1, 0.)
     , fusion_qubits_min_(4)
     , fusion_qubits_max_(max_qubit_num_)
     , rnd_eng_(seed)
     , backend_type_(backends::SimBackend::Unknown)
-    , backend_kernel_(nullptr)
+    , backend_kernel_(kernel)
+    , backend_structured_kernel_(structured_kernel)
+    , backend_sweep_kernel_(sweep_kernel)
+    , sweep_tile_qubits_(default_sweep_tile_qubits_)
+    , kernel_launches_(0)
+    , num_pins_(0)
 {
     vec_[0] = 1.;  // all-zero initial state
     std::uniform_real_distribution<double> dist(0., 1.);
     rng_ = [this, dist]() mutable { return dist(rnd_eng_); };
-
-    select_backend(backends::SimBackendGetEnv());
 }
 
-void Simulator::select_backend(backends::SimBackend backend)
+template <typename calc_t>
+void BasicSimulator<calc_t>::select_backend(backends::SimBackend backend)
 {
+    // The kernels acting on single-precision state vectors are exported with a "_float" suffix
+    const std::string suffix = std::is_same_v<calc_t, float> ? "_float" : "";
+    const auto kernel_name = "kernel" + suffix;
+    const auto structured_name = "kernel_structured" + suffix;
+    const auto sweep_name = "kernel_sweep" + suffix;
+
     pybind11::module_ module = backends::SimBackendAcquire(backend);
-    backend_kernel_ = reinterpret_cast<backend_kernel_t*>(pybind11::cast<void*>(module.attr("kernel")()));
+    if (!pybind11::hasattr(module, kernel_name.c_str())) {
+        throw std::runtime_error("select_backend(): the backend does not export '" + kernel_name + "'"
+                                 + (suffix.empty() ? "!" : " (no support for single-precision state vectors)!"));
+    }
+    backend_kernel_ = reinterpret_cast<backend_kernel_t*>(pybind11::cast<void*>(module.attr(kernel_name.c_str())()));
+    backend_structured_kernel_ = nullptr;
+    if (pybind11::hasattr(module, structured_name.c_str())) {
+        backend_structured_kernel_ = reinterpret_cast<backend_structured_kernel_t*>(
+            pybind11::cast<void*>(module.attr(structured_name.c_str())()));
+    }
+    backend_sweep_kernel_ = nullptr;
+    if (pybind11::hasattr(module, sweep_name.c_str())) {
+        backend_sweep_kernel_ = reinterpret_cast<backend_sweep_kernel_t*>(
+            pybind11::cast<void*>(module.attr(sweep_name.c_str())()));
+    }
     backend_type_ = backend;
 }
 
-void Simulator::run()
+template <typename calc_t>
+void BasicSimulator<calc_t>::run()
 {
+    extend_state_();
     if (fused_gates_.size() < 1UL) {
         return;
     }
 
-    fusion::Fusion::Matrix m;
-    fusion::Fusion::IndexVector ids;
+    update_layout_();
+    apply_fusion_(fused_gates_);
+
+    fused_gates_ = fusion::Fusion();
+}
+
+template <typename calc_t>
+void BasicSimulator<calc_t>::apply_fused_blocks(std::vector<fusion::Fusion>& blocks)
+{
+    run();
+    update_layout_();
+
+    std::vector<fusion::FusedGate> gates;
+    gates.reserve(blocks.size());
+    for (auto& block: blocks) {
+        if (block.size() > 0UL) {
+            gates.emplace_back(prepare_fusion_(block));
+        }
+    }
+
+    // Consecutive gates whose targets lie within a tile are applied tile by tile in a single pass over the state
+    // vector. Gates acting on higher qubits require a full pass of their own.
+    const auto use_sweep = backend_sweep_kernel_ != nullptr && sweep_tile_qubits_ > 0 && N_ > sweep_tile_qubits_;
+    std::size_t first = 0;
+    while (first < gates.size()) {
+        auto last = first;
+        while (use_sweep && last < gates.size() && gates[last].span() <= sweep_tile_qubits_) {
+            ++last;
+        }
+        if (last - first > 1) {
+            backend_sweep_kernel_(vec_, &gates[first], last - first, sweep_tile_qubits_);
+            ++kernel_launches_;
+            first = last;
+        }
+        else {
+            apply_fused_gate_(gates[first]);
+            ++first;
+        }
+    }
+}
+
+template <typename calc_t>
+void BasicSimulator<calc_t>::apply_fusion_(fusion::Fusion& fused_gates)
+{
+    apply_fused_gate_(prepare_fusion_(fused_gates));
+}
+
+template <typename calc_t>
+fusion::FusedGate BasicSimulator<calc_t>::prepare_fusion_(fusion::Fusion& fused_gates)
+{
+    fusion::FusedGate gate;
     fusion::Fusion::IndexVector ctrls;
 
-    fused_gates_.perform_fusion(m, ids, ctrls);
+    fused_gates.perform_fusion(gate.matrix, gate.ids, ctrls);
 
-    if (ids.size() > max_qubit_num_) {
+    if (gate.ids.size() > max_qubit_num_) {
         throw std::invalid_argument("Gates with more than 5 qubits are not supported!");
     }
 
-    for (auto& id: ids) {
+    if (layout_manager_) {
+        layout_manager_->record(gate.ids);
+    }
+
+    for (auto& id: gate.ids) {
         id = map_[id];
     }
 
     // Pad with zeros.
-    unsigned nids = ids.size();
-    ids.resize(max_qubit_num_);
+    gate.nids = gate.ids.size();
+    gate.ids.resize(max_qubit_num_);
 
-    auto ctrlmask = get_control_mask(ctrls);
+    gate.ctrlmask = get_control_mask(ctrls);
 
-    backend_kernel_(vec_, m, ctrlmask, ids, nids);
+    // Diagonal and permutation gates skip the dense matrix multiplication
+    if (backend_structured_kernel_ != nullptr) {
+        gate.structure = fusion::classify(gate.matrix);
+    }
+    return gate;
+}
 
-    fused_gates_ = fusion::Fusion();
+template <typename calc_t>
+void BasicSimulator<calc_t>::apply_fused_gate_(fusion::FusedGate const& gate)
+{
+    if (gate.structure.kind != fusion::GateKind::general) {
+        backend_structured_kernel_(vec_, gate.structure, gate.ctrlmask, gate.ids, gate.nids);
+    }
+    else {
+        backend_kernel_(vec_, gate.matrix, gate.ctrlmask, gate.ids, gate.nids);
+    }
+    ++kernel_launches_;
+}
+
+template <typename calc_t>
+void BasicSimulator<calc_t>::update_layout_()
+{
+    // NB: reordering the qubits would invalidate the mapping attached to the views of a pinned state vector
+    if (!layout_manager_ || !layout_manager_->due() || num_pins_ > 0) {
+        return;
+    }
+
+    const auto perm = layout_manager_->plan(map_);
+    if (perm.empty()) {
+        return;
+    }
+
+    auto newvec = workspace_.acquire(vec_.size());  // avoid costly memory reallocations
+    layout::LayoutManager::permute(vec_, *newvec, perm);
+    std::swap(vec_, *newvec);
+
+    for (auto& p: map_) {
+        p.second = perm[p.second];
+    }
 }
 
-Simulator::StateVector Simulator::tmpBuff1_;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
-Simulator::StateVector Simulator::tmpBuff2_;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+template class BasicSimulator<double>;
+template class BasicSimulator<float>;
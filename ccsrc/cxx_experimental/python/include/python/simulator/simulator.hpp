@@ -15,4 +15,86 @@
 #ifndef PYTHON_SIMULATOR_HPP
 #define PYTHON_SIMULATOR_HPP
 
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+namespace mindquantum::python {
+namespace details {
+//! Owner of the memory of a NumPy view on the state vector of a simulator
+template <typename pin_t>
+struct StateViewOwner {
+    pybind11::object simulator;  // keeps the simulator alive
+    pin_t pin;                   // NB: released before the reference to the simulator
+};
+
+//! Create a NumPy view on the state vector of \c sim (see get_state_view())
+template <typename simulator_t>
+pybind11::tuple make_state_view(pybind11::object self, simulator_t& sim, bool writeable) {
+    namespace py = pybind11;
+
+    using pin_t = decltype(sim.pin_state());
+    using owner_t = StateViewOwner<pin_t>;
+
+    auto* owner = new owner_t{self, sim.pin_state()};
+    py::capsule base(owner, [](void* ptr) { delete static_cast<owner_t*>(ptr); });
+
+    auto [mapping, vec] = sim.cheat();
+    using value_t = typename std::remove_reference_t<decltype(vec)>::value_type;
+    py::array_t<value_t> array({static_cast<py::ssize_t>(vec.size())}, {static_cast<py::ssize_t>(sizeof(value_t))},
+                               vec.data(), base);
+    if (!writeable) {
+        py::detail::array_proxy(array.ptr())->flags &= ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+    }
+    return py::make_tuple(mapping, array);
+}
+}  // namespace details
+
+//! Return a (mapping, array) tuple where the NumPy array shares its memory with the state vector of a simulator
+/*!
+ * No copy of the state vector is made. The array holds a pin on the state vector (and a reference to the simulator)
+ * so that the simulator can neither be destroyed nor reallocate or reorder the state vector for as long as the array
+ * or any view derived from it is alive. The dtype of the array is complex64 or complex128 depending on the precision
+ * of the simulator.
+ *
+ * \param self Python simulator object (must provide \c visit(), see simulation::projectq::Simulator)
+ * \param writeable Whether the array may be used to modify the state vector in place
+ */
+template <typename simulator_t>
+pybind11::tuple get_state_view(pybind11::object self, bool writeable) {
+    return self.cast<simulator_t&>().visit(
+        [&self, writeable](auto& sim) { return details::make_state_view(self, sim, writeable); });
+}
+
+//! Return a (mapping, state) tuple with a copy of the state vector of a simulator
+template <typename simulator_t>
+pybind11::tuple cheat(simulator_t& sim) {
+    return sim.visit([](auto& impl) {
+        auto [mapping, vec] = impl.cheat();
+        return pybind11::make_tuple(mapping, vec);
+    });
+}
+
+//! Set the state vector of a simulator from a NumPy array, copying the amplitudes directly into the state vector
+/*!
+ * C-contiguous complex128 arrays are read in place; any other array is converted first.
+ */
+template <typename simulator_t>
+void set_state_from_buffer(simulator_t& sim,
+                           const pybind11::array_t<std::complex<double>, pybind11::array::c_style
+                                                                              | pybind11::array::forcecast>& array,
+                           const std::vector<unsigned>& ordering) {
+    if (array.ndim() != 1) {
+        throw std::invalid_argument("set_state_from_buffer(): expected a one-dimensional array!");
+    }
+    sim.set_wavefunction(array.data(), static_cast<std::size_t>(array.size()), ordering);
+}
+}  // namespace mindquantum::python
+
 #endif /* PYTHON_SIMULATOR_HPP */
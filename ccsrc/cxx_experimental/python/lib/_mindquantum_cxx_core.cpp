@@ -39,7 +39,11 @@ PYBIND11_MODULE(_mindquantum_cxx_core, m) {
         .def("set_simulator_backend", &CppCore::set_simulator_backend)
         .def("allocate_qubit", &CppCore::allocate_qubit)
         .def("apply_command", &CppCore::apply_command)
+        .def("set_deferred_execution", &CppCore::set_deferred_execution)
+        .def("deferred_execution", &CppCore::deferred_execution)
+        .def("set_fusion_planner", &CppCore::set_fusion_planner)
         .def("flush", &CppCore::flush)
+        .def("get_kernel_launches", &CppCore::get_kernel_launches)
         .def("get_measure_info", &CppCore::get_measure_info)
         .def("set_output_stream", &CppCore::set_output_stream)
         .def("write", &CppCore::write)
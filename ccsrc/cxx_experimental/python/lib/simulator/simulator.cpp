@@ -15,6 +15,7 @@
 #include "python/simulator/simulator.hpp"
 
 #include <pybind11/complex.h>
+#include <pybind11/numpy.h>
 #include <pybind11/operators.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
@@ -32,8 +33,16 @@ void mindquantum::python::init_simulator(pybind11::module& module) {
     using pq_simulator = simulation::projectq::Simulator;
 
     py::module projectq = module.def_submodule("projectq", "MindQuantum-C++ ProjectQ C++ simulator");
-    py::class_<pq_simulator>(projectq, "Simulator")
-        .def(py::init<uint32_t>())
+    py::class_<pq_simulator> simulator(projectq, "Simulator");
+
+    py::enum_<pq_simulator::precision_t>(simulator, "precision_t")
+        .value("fp64", pq_simulator::precision_t::fp64)
+        .value("fp32", pq_simulator::precision_t::fp32);
+
+    simulator
+        .def(py::init<uint32_t, pq_simulator::precision_t>(), py::arg("seed") = 0,
+             py::arg("precision") = pq_simulator::precision_t::fp64)
+        .def_property_readonly("precision", &pq_simulator::precision)
         .def("run_circuit",
              static_cast<bool (pq_simulator::*)(const circuit_t&)>(&pq_simulator::run_circuit<mindquantum::circuit_t>),
              py::arg("Circuit"))
@@ -44,5 +53,7 @@ void mindquantum::python::init_simulator(pybind11::module& module) {
         .def("is_classical", &pq_simulator::is_classical)
         .def("get_classical_value", &pq_simulator::get_classical_value)
         .def("measure_qubits", &pq_simulator::measure_qubits_return)
-        .def("cheat", &pq_simulator::cheat);
+        .def("cheat", &cheat<pq_simulator>)
+        .def("get_state_view", &get_state_view<pq_simulator>, py::arg("writeable") = false)
+        .def("set_state_from_buffer", &set_state_from_buffer<pq_simulator>, py::arg("state"), py::arg("ordering"));
 }
@@ -116,6 +116,8 @@ enum SparseHow : int64_t {
     ORIGIN = 0,
     BACKEND,
     FRONTEND,
+    MATRIXFREE,
+    COMPRESSED,
 };
 enum HermitianProp : int64_t {
     SELFHERMITIAN = 0,
@@ -17,14 +17,18 @@
 #ifndef MINDQUANTUM_HAMILTONIAN_HAMILTONIAN_H_
 #define MINDQUANTUM_HAMILTONIAN_HAMILTONIAN_H_
 #include <memory>
+#include <stdexcept>
 
 #include "core/utils.h"
 #include "sparse/algo.h"
+#include "sparse/pauli_operator.h"
 
 namespace mindquantum {
+using mindquantum::sparse::CompactCsrHdMatrix;
+using mindquantum::sparse::CompressCsrHdMatrix;
 using mindquantum::sparse::CsrHdMatrix;
+using mindquantum::sparse::PauliOperator;
 using mindquantum::sparse::SparseHamiltonian;
-using mindquantum::sparse::TransposeCsrHdMatrix;
 
 template <typename T>
 struct Hamiltonian {
@@ -32,7 +36,8 @@ struct Hamiltonian {
     Index n_qubits_;
     VT<PauliTerm<T>> ham_;
     std::shared_ptr<CsrHdMatrix<T>> ham_sparse_main_;
-    std::shared_ptr<CsrHdMatrix<T>> ham_sparse_second_;
+    std::shared_ptr<PauliOperator<T>> ham_matrix_free_;
+    std::shared_ptr<CompactCsrHdMatrix<T>> ham_sparse_compact_;
 
     Hamiltonian() {
     }
@@ -40,12 +45,29 @@ struct Hamiltonian {
     explicit Hamiltonian(const VT<PauliTerm<T>> &ham) : how_to_(ORIGIN), ham_(ham) {
     }
 
-    Hamiltonian(const VT<PauliTerm<T>> &ham, Index n_qubits) : how_to_(BACKEND), n_qubits_(n_qubits), ham_(ham) {
+    Hamiltonian(const VT<PauliTerm<T>> &ham, Index n_qubits) : Hamiltonian(ham, n_qubits, BACKEND) {
+    }
+
+    // BACKEND builds the sparse matrix of the hamiltonian, COMPRESSED additionally converts it to its compact form,
+    // while MATRIXFREE only keeps the masks of the pauli terms and applies them on the fly.
+    Hamiltonian(const VT<PauliTerm<T>> &ham, Index n_qubits, int64_t how_to)
+        : how_to_(how_to), n_qubits_(n_qubits), ham_(ham) {
+        if (how_to_ == MATRIXFREE) {
+            ham_matrix_free_ = std::make_shared<PauliOperator<T>>(ham_, n_qubits_);
+            return;
+        }
+        if (how_to_ != BACKEND && how_to_ != COMPRESSED) {
+            throw std::invalid_argument(
+                "Hamiltonian: pauli terms can only be stored in backend, matrix free or compressed mode.");
+        }
         if (n_qubits_ > 16) {
             std::cout << "Sparsing hamiltonian ..." << std::endl;
         }
         ham_sparse_main_ = SparseHamiltonian(ham_, n_qubits_);
-        ham_sparse_second_ = TransposeCsrHdMatrix(ham_sparse_main_);
+        if (how_to_ == COMPRESSED) {
+            ham_sparse_compact_ = CompressCsrHdMatrix(ham_sparse_main_);
+            ham_sparse_main_ = nullptr;
+        }
         if (n_qubits_ > 16) {
             std::cout << "Sparsing hamiltonian finished!" << std::endl;
         }
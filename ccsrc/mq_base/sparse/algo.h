@@ -15,9 +15,15 @@
  */
 #ifndef MINDQUANTUM_SPARSE_ALGO_H_
 #define MINDQUANTUM_SPARSE_ALGO_H_
+#include <algorithm>
+#include <map>
 #include <memory>
+#include <stdexcept>
+#include <utility>
 
+#include "sparse/compact_csrhdmatrix.h"
 #include "sparse/csrhdmatrix.h"
+#include "sparse/pauli_operator.h"
 #include "sparse/paulimat.h"
 #include "sparse/sparse_utils.h"
 
@@ -118,35 +124,71 @@ std::shared_ptr<CsrHdMatrix<T>> Csr_Plus_Csr(std::shared_ptr<CsrHdMatrix<T>> a,
     return c;
 }
 
+// Build the half diagonal csr matrix of a pauli hamiltonian in a single pass.
+//
+// Terms sharing the same flip mask x contribute to the same column i ^ x of row i, so the hamiltonian is first grouped
+// by flip mask. The number of non zero elements of every row is then counted in parallel, the final arrays are
+// allocated once, and every row is filled in parallel.
 template <typename T>
 std::shared_ptr<CsrHdMatrix<T>> SparseHamiltonian(const VT<PauliTerm<T>> &hams, Index n_qubits) {
-    VT<std::shared_ptr<CsrHdMatrix<T>>> sp_hams(hams.size());
-
+    PauliOperator<T> op(hams, n_qubits);
+    auto dim = op.dim_;
+    auto n_groups = static_cast<Index>(op.mask_x_.size());
+    auto &mask_x = op.mask_x_;
+    Index *indptr = reinterpret_cast<Index *>(malloc(sizeof(Index) * (dim + 1)));
+    indptr[0] = 0;
 #pragma omp parallel for schedule(static)
-    for (Index i = 0; i < static_cast<Index>(hams.size()); i++) {
-        auto pm = GetPauliMat(hams[i], n_qubits);
-        sp_hams[i] = PauliMatToCsrHdMatrix(pm);
-        pm->Reset();
+    for (Index i = 0; i < dim; i++) {
+        Index row_nnz = 0;
+        for (Index g = 0; g < n_groups; g++) {
+            auto j = i ^ mask_x[g];
+            if (i <= j && std::abs(op.GroupCoeff(g, j)) > PRECISION) {
+                row_nnz++;
+            }
+        }
+        indptr[i + 1] = row_nnz;
     }
-    Index tot = static_cast<Index>(hams.size());
-    while (tot > 1) {
-        Index half = tot / 2 + tot % 2;
-#pragma omp parallel for schedule(static) num_threads(half)
-        for (Index i = half; i < tot; i++) {
-            sp_hams[i - half] = Csr_Plus_Csr(sp_hams[i - half], sp_hams[i]);
-            sp_hams[i]->Reset();
+    for (Index i = 0; i < dim; i++) {
+        indptr[i + 1] += indptr[i];
+    }
+    auto nnz = indptr[dim];
+    Index *indices = reinterpret_cast<Index *>(malloc(sizeof(Index) * nnz));
+    CTP<T> data = reinterpret_cast<CTP<T>>(malloc(sizeof(CT<T>) * nnz));
+#pragma omp parallel
+    {
+        VT<std::pair<Index, CT<T>>> row;
+        row.reserve(n_groups);
+#pragma omp for schedule(static)
+        for (Index i = 0; i < dim; i++) {
+            row.clear();
+            for (Index g = 0; g < n_groups; g++) {
+                auto j = i ^ mask_x[g];
+                if (i <= j) {
+                    auto value = op.GroupCoeff(g, j);
+                    if (std::abs(value) > PRECISION) {
+                        row.emplace_back(j, i == j ? value * static_cast<T>(0.5) : value);
+                    }
+                }
+            }
+            std::sort(row.begin(), row.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+            for (size_t k = 0; k < row.size(); k++) {
+                indices[indptr[i] + k] = row[k].first;
+                data[indptr[i] + k] = row[k].second;
+            }
         }
-        tot = half;
     }
-    return sp_hams[0];
+    auto c = std::make_shared<CsrHdMatrix<T>>(dim, nnz, indptr, indices, data);
+    return c;
 }
 
+// Multiply a csr matrix with a vector, writing the result into out.
+//
+// out must hold dim complex numbers and must not overlap with vec.
 template <typename T, typename T2>
-T2 *Csr_Dot_Vec(std::shared_ptr<CsrHdMatrix<T>> a, T2 *vec) {
+void Csr_Dot_Vec(std::shared_ptr<CsrHdMatrix<T>> a, const T2 *vec, T2 *out) {
     auto dim = a->dim_;
-    auto c_vec = reinterpret_cast<CTP<T2>>(vec);
-    auto new_vec = reinterpret_cast<CTP<T2>>(malloc(sizeof(CT<T2>) * dim));
-    // auto nnz = a->nnz_;
+    auto c_vec = reinterpret_cast<const CT<T2> *>(vec);
+    auto c_out = reinterpret_cast<CTP<T2>>(out);
     auto data = a->data_;
     auto indptr = a->indptr_;
     auto indices = a->indices_;
@@ -156,38 +198,114 @@ T2 *Csr_Dot_Vec(std::shared_ptr<CsrHdMatrix<T>> a, T2 *vec) {
         for (Index j = indptr[i]; j < indptr[i + 1]; j++) {
             sum += data[j] * c_vec[indices[j]];
         }
-        new_vec[i] = sum;
+        c_out[i] = sum;
     }
-    free(vec);
-    return reinterpret_cast<T2 *>(new_vec);
 }
 
+// Compute <bra|a|ket> without storing a|ket>.
 template <typename T, typename T2>
-T2 *Csr_Dot_Vec(std::shared_ptr<CsrHdMatrix<T>> a, std::shared_ptr<CsrHdMatrix<T>> b, T2 *vec) {
+CT<T2> Csr_Inner_Product(std::shared_ptr<CsrHdMatrix<T>> a, const T2 *bra, const T2 *ket) {
     auto dim = a->dim_;
-    auto c_vec = reinterpret_cast<CTP<T2>>(vec);
-    auto new_vec = reinterpret_cast<CTP<T2>>(malloc(sizeof(CT<T2>) * dim));
-    // auto nnz = a->nnz_;
+    auto c_bra = reinterpret_cast<const CT<T2> *>(bra);
+    auto c_ket = reinterpret_cast<const CT<T2> *>(ket);
     auto data = a->data_;
     auto indptr = a->indptr_;
     auto indices = a->indices_;
-    auto data_b = b->data_;
-    auto indptr_b = b->indptr_;
-    auto indices_b = b->indices_;
-
-#pragma omp parallel for schedule(static)
+    T2 real_part = 0;
+    T2 imag_part = 0;
+#pragma omp parallel for schedule(static) reduction(+ : real_part, imag_part)
     for (Index i = 0; i < dim; i++) {
         CT<T2> sum = {0.0, 0.0};
         for (Index j = indptr[i]; j < indptr[i + 1]; j++) {
-            sum += data[j] * c_vec[indices[j]];
+            sum += data[j] * c_ket[indices[j]];
         }
-        for (Index j = indptr_b[i]; j < indptr_b[i + 1]; j++) {
-            sum += data_b[j] * c_vec[indices_b[j]];
+        auto v = std::conj(c_bra[i]) * sum;
+        real_part += v.real();
+        imag_part += v.imag();
+    }
+    return {real_part, imag_part};
+}
+
+// Multiply a hermitian matrix, stored as its upper half with the diagonal halved, with a vector, writing the result
+// into out.
+//
+// out must hold dim complex numbers and must not overlap with vec.
+template <typename T, typename T2>
+void HdCsr_Dot_Vec(std::shared_ptr<CsrHdMatrix<T>> a, const T2 *vec, T2 *out) {
+    auto data = a->data_;
+    hd_csr_dot_vec(
+        a->dim_, a->indptr_, a->indices_, [data](Index j) { return data[j]; }, reinterpret_cast<const CT<T2> *>(vec),
+        reinterpret_cast<CTP<T2>>(out));
+}
+
+// Compute <bra|a|ket> for a hermitian matrix stored as its upper half with the diagonal halved.
+template <typename T, typename T2>
+CT<T2> HdCsr_Inner_Product(std::shared_ptr<CsrHdMatrix<T>> a, const T2 *bra, const T2 *ket) {
+    auto data = a->data_;
+    return hd_csr_inner_product(
+        a->dim_, a->indptr_, a->indices_, [data](Index j) { return data[j]; }, reinterpret_cast<const CT<T2> *>(bra),
+        reinterpret_cast<const CT<T2> *>(ket));
+}
+
+// Convert a half diagonal csr matrix to its compact form.
+//
+// The column indices are narrowed to 32 bits and every distinct value is only stored once. Since the non zero
+// elements of a pauli hamiltonian are sums of a few coefficients times a power of i, far fewer distinct values than
+// non zero elements are expected.
+template <typename T>
+std::shared_ptr<CompactCsrHdMatrix<T>> CompressCsrHdMatrix(std::shared_ptr<CsrHdMatrix<T>> a) {
+    auto dim = a->dim_;
+    auto nnz = a->nnz_;
+    if (dim > (static_cast<Index>(1) << 32)) {
+        throw std::runtime_error("CompressCsrHdMatrix: dimension too large for 32 bits column indices.");
+    }
+    Index *indptr = reinterpret_cast<Index *>(malloc(sizeof(Index) * (dim + 1)));
+    uint32_t *indices = reinterpret_cast<uint32_t *>(malloc(sizeof(uint32_t) * nnz));
+    uint32_t *value_ids = reinterpret_cast<uint32_t *>(malloc(sizeof(uint32_t) * nnz));
+    std::copy(a->indptr_, a->indptr_ + dim + 1, indptr);
+    auto a_indices = a->indices_;
+#pragma omp parallel for schedule(static)
+    for (Index j = 0; j < nnz; j++) {
+        indices[j] = static_cast<uint32_t>(a_indices[j]);
+    }
+    VT<CT<T>> values;
+    std::map<std::pair<T, T>, uint32_t> table;
+    for (Index j = 0; j < nnz; j++) {
+        auto &v = a->data_[j];
+        auto it = table.emplace(std::make_pair(v.real(), v.imag()), static_cast<uint32_t>(values.size()));
+        if (it.second) {
+            if (values.size() == UINT32_MAX) {
+                free(indptr);
+                free(indices);
+                free(value_ids);
+                throw std::runtime_error("CompressCsrHdMatrix: too many distinct values.");
+            }
+            values.push_back(v);
         }
-        new_vec[i] = sum;
+        value_ids[j] = it.first->second;
     }
-    free(vec);
-    return reinterpret_cast<T2 *>(new_vec);
+    auto c = std::make_shared<CompactCsrHdMatrix<T>>(dim, nnz, indptr, indices, value_ids, values);
+    return c;
+}
+
+// Same as HdCsr_Dot_Vec(), for a compact half diagonal csr matrix.
+template <typename T, typename T2>
+void CompactCsr_Dot_Vec(std::shared_ptr<CompactCsrHdMatrix<T>> a, const T2 *vec, T2 *out) {
+    auto values = a->values_.data();
+    auto value_ids = a->value_ids_;
+    hd_csr_dot_vec(
+        a->dim_, a->indptr_, a->indices_, [values, value_ids](Index j) { return values[value_ids[j]]; },
+        reinterpret_cast<const CT<T2> *>(vec), reinterpret_cast<CTP<T2>>(out));
+}
+
+// Same as HdCsr_Inner_Product(), for a compact half diagonal csr matrix.
+template <typename T, typename T2>
+CT<T2> CompactCsr_Inner_Product(std::shared_ptr<CompactCsrHdMatrix<T>> a, const T2 *bra, const T2 *ket) {
+    auto values = a->values_.data();
+    auto value_ids = a->value_ids_;
+    return hd_csr_inner_product(
+        a->dim_, a->indptr_, a->indices_, [values, value_ids](Index j) { return values[value_ids[j]]; },
+        reinterpret_cast<const CT<T2> *>(bra), reinterpret_cast<const CT<T2> *>(ket));
 }
 }  // namespace sparse
 }  // namespace mindquantum
@@ -0,0 +1,78 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDQUANTUM_SPARSE_COMPACT_CSR_HD_MATRIX_H_
+#define MINDQUANTUM_SPARSE_COMPACT_CSR_HD_MATRIX_H_
+#include <cstdint>
+
+#include "core/utils.h"
+
+namespace mindquantum {
+namespace sparse {
+// Half diagonal csr matrix with 32 bits column indices, where every element refers to an entry of a table of distinct
+// values.
+template <typename T>
+struct CompactCsrHdMatrix {
+    Index dim_;
+    Index nnz_;
+    Index *indptr_;
+    uint32_t *indices_;
+    uint32_t *value_ids_;
+    VT<CT<T>> values_;
+
+    void FreeMemory() {
+        if (indptr_ != nullptr) {
+            free(indptr_);
+        }
+        if (indices_ != nullptr) {
+            free(indices_);
+        }
+        if (value_ids_ != nullptr) {
+            free(value_ids_);
+        }
+        indptr_ = nullptr;
+        indices_ = nullptr;
+        value_ids_ = nullptr;
+    }
+    void Reset() {
+        FreeMemory();
+        values_.clear();
+    }
+    ~CompactCsrHdMatrix() {
+        FreeMemory();
+    }
+    CompactCsrHdMatrix() : dim_(0), nnz_(0), indptr_(nullptr), indices_(nullptr), value_ids_(nullptr) {
+    }
+    CompactCsrHdMatrix(Index dim, Index nnz, Index *indptr, uint32_t *indices, uint32_t *value_ids,
+                       const VT<CT<T>> &values)
+        : dim_(dim), nnz_(nnz), indptr_(indptr), indices_(indices), value_ids_(value_ids), values_(values) {
+    }
+    void PrintInfo() {
+        std::cout << "<--Compact Csr Half Diag Matrix with Dimension: ";
+        std::cout << dim_ << " X " << dim_ << ", nnz: " << nnz_ << ", and distinct values: " << values_.size()
+                  << std::endl;
+        std::cout << "   Values:\n   ";
+        for (size_t i = 0; i < values_.size(); ++i) {
+            std::cout << values_[i];
+            if (i != values_.size() - 1) {
+                std::cout << ",";
+            }
+        }
+        std::cout << "-->\n\n";
+    }
+};
+}  // namespace sparse
+}  // namespace mindquantum
+#endif  // MINDQUANTUM_SPARSE_COMPACT_CSR_HD_MATRIX_H_
@@ -0,0 +1,127 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDQUANTUM_SPARSE_PAULI_OPERATOR_H_
+#define MINDQUANTUM_SPARSE_PAULI_OPERATOR_H_
+#include <map>
+#include <memory>
+
+#include "core/utils.h"
+
+namespace mindquantum {
+namespace sparse {
+// Matrix free representation of a pauli hamiltonian.
+//
+// A pauli term P maps the basis state |j> to i^num_y * (-1)^|j & (mask_y|mask_z)| |j ^ (mask_x|mask_y)>, so a term
+// is fully described by its flip mask, its sign mask and a complex coefficient. Terms are grouped by flip mask, so
+// that every group only needs a single gather of the state vector per amplitude.
+template <typename T>
+struct PauliOperator {
+    Index n_qubits_;
+    Index dim_;
+    VT<Index> mask_x_;     // flip mask of every group
+    VT<Index> group_ptr_;  // terms of group g are [group_ptr_[g], group_ptr_[g + 1])
+    VT<Index> mask_z_;     // sign mask of every term
+    VT<CT<T>> coeff_;      // coefficient of every term, including the i^num_y phase
+
+    PauliOperator() : n_qubits_(0), dim_(0) {
+    }
+    PauliOperator(const VT<PauliTerm<T>> &hams, Index n_qubits) : n_qubits_(n_qubits) {
+        dim_ = (1UL << n_qubits_);
+        std::map<Index, std::map<Index, CT<T>>> groups;
+        for (auto &pt : hams) {
+            auto mask = GetPauliMask(pt.first);
+            groups[mask.mask_x | mask.mask_y][mask.mask_y | mask.mask_z] += pt.second * CT<T>(POLAR[mask.num_y & 3]);
+        }
+        group_ptr_.push_back(0);
+        for (auto &group : groups) {
+            for (auto &term : group.second) {
+                if (std::abs(term.second) > PRECISION) {
+                    mask_z_.push_back(term.first);
+                    coeff_.push_back(term.second);
+                }
+            }
+            if (static_cast<Index>(mask_z_.size()) != group_ptr_.back()) {
+                mask_x_.push_back(group.first);
+                group_ptr_.push_back(static_cast<Index>(mask_z_.size()));
+            }
+        }
+    }
+    // Sum of the coefficients of group g acting on the basis state |j>
+    inline CT<T> GroupCoeff(Index g, Index j) const {
+        CT<T> c = {0.0, 0.0};
+        for (Index k = group_ptr_[g]; k < group_ptr_[g + 1]; k++) {
+            if (CountOne(j & mask_z_[k]) & 1) {
+                c -= coeff_[k];
+            } else {
+                c += coeff_[k];
+            }
+        }
+        return c;
+    }
+    void PrintInfo() {
+        std::cout << "<--Matrix Free Pauli Operator with Dimension: ";
+        std::cout << dim_ << " X " << dim_ << ", groups: " << mask_x_.size() << ", and terms: " << coeff_.size()
+                  << "-->\n\n";
+    }
+};
+
+// Apply a matrix free pauli operator on a vector, writing the result into out.
+//
+// out must hold dim complex numbers and must not overlap with vec.
+template <typename T, typename T2>
+void PauliOperator_Dot_Vec(std::shared_ptr<PauliOperator<T>> a, const T2 *vec, T2 *out) {
+    auto dim = a->dim_;
+    auto c_vec = reinterpret_cast<const CT<T2> *>(vec);
+    auto c_out = reinterpret_cast<CTP<T2>>(out);
+    auto n_groups = static_cast<Index>(a->mask_x_.size());
+    auto mask_x = a->mask_x_.data();
+#pragma omp parallel for schedule(static)
+    for (Index i = 0; i < dim; i++) {
+        CT<T2> sum = {0.0, 0.0};
+        for (Index g = 0; g < n_groups; g++) {
+            auto j = i ^ mask_x[g];
+            sum += CT<T2>(a->GroupCoeff(g, j)) * c_vec[j];
+        }
+        c_out[i] = sum;
+    }
+}
+
+// Compute <bra|a|ket> without storing a|ket>.
+template <typename T, typename T2>
+CT<T2> PauliOperator_Inner_Product(std::shared_ptr<PauliOperator<T>> a, const T2 *bra, const T2 *ket) {
+    auto dim = a->dim_;
+    auto c_bra = reinterpret_cast<const CT<T2> *>(bra);
+    auto c_ket = reinterpret_cast<const CT<T2> *>(ket);
+    auto n_groups = static_cast<Index>(a->mask_x_.size());
+    auto mask_x = a->mask_x_.data();
+    T2 real_part = 0;
+    T2 imag_part = 0;
+#pragma omp parallel for schedule(static) reduction(+ : real_part, imag_part)
+    for (Index i = 0; i < dim; i++) {
+        CT<T2> sum = {0.0, 0.0};
+        for (Index g = 0; g < n_groups; g++) {
+            auto j = i ^ mask_x[g];
+            sum += CT<T2>(a->GroupCoeff(g, j)) * c_ket[j];
+        }
+        auto v = std::conj(c_bra[i]) * sum;
+        real_part += v.real();
+        imag_part += v.imag();
+    }
+    return {real_part, imag_part};
+}
+}  // namespace sparse
+}  // namespace mindquantum
+#endif  // MINDQUANTUM_SPARSE_PAULI_OPERATOR_H_
@@ -88,6 +88,75 @@ void csr_plus_csr(Index dim, const Index *a_indptr, const Index *aj, const T *ad
         cp[i + 1] = nnz;
     }
 }
+
+// Multiply a hermitian matrix, stored as its upper half with the diagonal halved, with a vector.
+//
+// value(j) returns the j-th stored element. Every stored element a_ij contributes a_ij * v_j to row i and
+// conj(a_ij) * v_i to row j. The rows are split into one block per thread, and the conjugate contributions are
+// scattered in rounds: during round k, the thread owning block t only writes into block t + k, so that two threads
+// never write to the same block and no atomic operation is needed.
+template <typename T2, typename IndexT, typename ValueF>
+void hd_csr_dot_vec(Index dim, const Index *indptr, const IndexT *indices, const ValueF &value,
+                    const std::complex<T2> *vec, std::complex<T2> *out) {
+#pragma omp parallel
+    {
+#ifdef USE_OPENMP
+        Index n_blocks = omp_get_num_threads();
+        Index block = omp_get_thread_num();
+#else
+        Index n_blocks = 1;
+        Index block = 0;
+#endif  // USE_OPENMP
+        Index begin = dim * block / n_blocks;
+        Index end = dim * (block + 1) / n_blocks;
+        for (Index i = begin; i < end; i++) {
+            std::complex<T2> sum = {0.0, 0.0};
+            for (Index j = indptr[i]; j < indptr[i + 1]; j++) {
+                sum += value(j) * vec[indices[j]];
+            }
+            out[i] = sum;
+        }
+        // Since the columns of every row are sorted, each round resumes where the previous one stopped.
+        std::vector<Index> cursor(indptr + begin, indptr + end);
+        for (Index k = 0; k < n_blocks; k++) {
+            if (block + k < n_blocks) {
+                Index dest_end = dim * (block + k + 1) / n_blocks;
+                for (Index i = begin; i < end; i++) {
+                    auto &j = cursor[i - begin];
+                    for (; j < indptr[i + 1] && static_cast<Index>(indices[j]) < dest_end; j++) {
+                        out[indices[j]] += std::conj(value(j)) * vec[i];
+                    }
+                }
+            }
+#pragma omp barrier
+        }
+    }
+}
+
+// Compute <bra|a|ket> for a hermitian matrix stored as its upper half with the diagonal halved.
+//
+// Contrary to hd_csr_dot_vec(), the conjugate contribution conj(bra_j) * conj(a_ij) * ket_i of every stored element
+// only feeds the reduction, so no scattering is required.
+template <typename T2, typename IndexT, typename ValueF>
+std::complex<T2> hd_csr_inner_product(Index dim, const Index *indptr, const IndexT *indices, const ValueF &value,
+                                      const std::complex<T2> *bra, const std::complex<T2> *ket) {
+    T2 real_part = 0;
+    T2 imag_part = 0;
+#pragma omp parallel for schedule(static) reduction(+ : real_part, imag_part)
+    for (Index i = 0; i < dim; i++) {
+        std::complex<T2> sum = {0.0, 0.0};
+        std::complex<T2> sum_conj = {0.0, 0.0};
+        for (Index j = indptr[i]; j < indptr[i + 1]; j++) {
+            auto v = value(j);
+            sum += v * ket[indices[j]];
+            sum_conj += std::conj(v * bra[indices[j]]);
+        }
+        auto res = std::conj(bra[i]) * sum + sum_conj * ket[i];
+        real_part += res.real();
+        imag_part += res.imag();
+    }
+    return {real_part, imag_part};
+}
 }  // namespace sparse
 }  // namespace mindquantum
 #endif  // MINDQUANTUM_SPARSE_SPARSE_UTILS_H_
@@ -28,15 +28,20 @@
 #include "matrix/two_dim_matrix.h"
 #include "pr/parameter_resolver.h"
 #include "sparse/algo.h"
+#include "sparse/compact_csrhdmatrix.h"
 #include "sparse/csrhdmatrix.h"
+#include "sparse/pauli_operator.h"
 #include "sparse/paulimat.h"
 
 namespace py = pybind11;
 namespace mindquantum {
+using mindquantum::sparse::CompactCsrHdMatrix;
+using mindquantum::sparse::CompressCsrHdMatrix;
 using mindquantum::sparse::Csr_Plus_Csr;
 using mindquantum::sparse::GetPauliMat;
 using mindquantum::sparse::PauliMat;
 using mindquantum::sparse::PauliMatToCsrHdMatrix;
+using mindquantum::sparse::PauliOperator;
 using mindquantum::sparse::SparseHamiltonian;
 using mindquantum::sparse::TransposeCsrHdMatrix;
 
@@ -102,17 +107,35 @@ PYBIND11_MODULE(mqbackend, m) {
     m.def("transpose_csr_hd_matrix", &TransposeCsrHdMatrix<MT>);
     m.def("pauli_mat_to_csr_hd_matrix", &PauliMatToCsrHdMatrix<MT>);
 
+    // compact csr_hd_matrix
+    py::class_<CompactCsrHdMatrix<MT>, std::shared_ptr<CompactCsrHdMatrix<MT>>>(m, "compact_csr_hd_matrix")
+        .def(py::init<>())
+        .def_readonly("dim", &CompactCsrHdMatrix<MT>::dim_)
+        .def_readonly("nnz", &CompactCsrHdMatrix<MT>::nnz_)
+        .def("PrintInfo", &CompactCsrHdMatrix<MT>::PrintInfo);
+    m.def("compress_csr_hd_matrix", &CompressCsrHdMatrix<MT>);
+
+    // matrix free pauli operator
+    py::class_<PauliOperator<MT>, std::shared_ptr<PauliOperator<MT>>>(m, "pauli_operator")
+        .def(py::init<>())
+        .def(py::init<const VT<PauliTerm<MT>> &, Index>())
+        .def_readonly("n_qubits", &PauliOperator<MT>::n_qubits_)
+        .def_readonly("dim", &PauliOperator<MT>::dim_)
+        .def("PrintInfo", &PauliOperator<MT>::PrintInfo);
+
     // hamiltonian
     py::class_<Hamiltonian<MT>, std::shared_ptr<Hamiltonian<MT>>>(m, "hamiltonian")
         .def(py::init<>())
         .def(py::init<const VT<PauliTerm<MT>> &>())
         .def(py::init<const VT<PauliTerm<MT>> &, Index>())
+        .def(py::init<const VT<PauliTerm<MT>> &, Index, int64_t>())
         .def(py::init<std::shared_ptr<CsrHdMatrix<MT>>, Index>())
         .def_readwrite("how_to", &Hamiltonian<MT>::how_to_)
         .def_readwrite("n_qubits", &Hamiltonian<MT>::n_qubits_)
         .def_readwrite("ham", &Hamiltonian<MT>::ham_)
         .def_readwrite("ham_sparse_main", &Hamiltonian<MT>::ham_sparse_main_)
-        .def_readwrite("ham_sparse_second", &Hamiltonian<MT>::ham_sparse_second_);
+        .def_readwrite("ham_matrix_free", &Hamiltonian<MT>::ham_matrix_free_)
+        .def_readwrite("ham_sparse_compact", &Hamiltonian<MT>::ham_sparse_compact_);
     m.def("sparse_hamiltonian", &SparseHamiltonian<MT>);
 
 #ifdef ENABLE_PROJECTQ
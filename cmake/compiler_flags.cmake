@@ -152,6 +152,11 @@ if(X86_64)
     LANGS C CXX DPCXX
     NO_MQ_TARGET NO_TRYCOMPILE_TARGET NO_TRYCOMPILE_FLAGCHECK_TARGET
     FLAGS "-mavx2 -xCORE-AVX2 /QxCORE-AVX2 /arch:AVX2")
+  test_compile_option(
+    intrin_avx512_flag
+    LANGS C CXX DPCXX
+    NO_MQ_TARGET NO_TRYCOMPILE_TARGET NO_TRYCOMPILE_FLAGCHECK_TARGET
+    FLAGS "-mavx512f -xCORE-AVX512 /QxCORE-AVX512 /arch:AVX512")
 elseif(AARCH64)
   test_compile_option(
     intrin_flag
@@ -164,6 +169,9 @@ foreach(_lang C CXX DPCXX)
   if(TARGET intrin_flag_${_lang})
     append_to_property(mq_install_targets GLOBAL intrin_flag_${_lang})
   endif()
+  if(TARGET intrin_avx512_flag_${_lang})
+    append_to_property(mq_install_targets GLOBAL intrin_avx512_flag_${_lang})
+  endif()
 endforeach()
 
 # --------------------------------------
@@ -30,8 +30,8 @@ except ImportError:
         """Dummy class for ProjectQ operators."""
 
 
-MODE = {'origin': 0, 'backend': 1, 'frontend': 2}
-EDOM = {0: 'origin', 1: 'backend', 2: 'frontend'}
+MODE = {'origin': 0, 'backend': 1, 'frontend': 2, 'matrixfree': 3, 'compressed': 4}
+EDOM = {0: 'origin', 1: 'backend', 2: 'frontend', 3: 'matrixfree', 4: 'compressed'}
 
 
 class Hamiltonian:
@@ -89,20 +89,31 @@ class Hamiltonian:
             return self.sparse_mat.__str__()
         return self.hamiltonian.__repr__()
 
-    def sparse(self, n_qubits=1):
+    def sparse(self, n_qubits=1, matrix_free=False, compressed=False):
         """
         Calculate the sparse matrix of this hamiltonian in pqc operator.
 
         Args:
             n_qubits (int): The total qubit of this hamiltonian, only need when mode is
                 'frontend'. Default: 1.
+            matrix_free (bool): Whether to apply the pauli terms on the fly instead of building the sparse
+                matrix, which saves both memory and construction time for large hamiltonians. Default: False.
+            compressed (bool): Whether to store the sparse matrix with 32 bits indices and a table of distinct
+                values, which reduces its memory footprint by a factor 2 to 3. Default: False.
         """
         if EDOM[self.how_to] != 'origin':
             raise ValueError('Already a sparse hamiltonian.')
         if n_qubits < self.n_qubits:
             raise ValueError(f"Can not sparse a {self.n_qubits} qubits hamiltonian to {n_qubits} hamiltonian.")
+        if matrix_free and compressed:
+            raise ValueError("A hamiltonian can not be both matrix free and compressed.")
         self.n_qubits = n_qubits
-        self.how_to = MODE['backend']
+        if matrix_free:
+            self.how_to = MODE['matrixfree']
+        elif compressed:
+            self.how_to = MODE['compressed']
+        else:
+            self.how_to = MODE['backend']
         return self
 
     def get_cpp_obj(self, hermitian=False):
@@ -118,6 +129,8 @@ class Hamiltonian:
                     ham = mb.hamiltonian(self.ham_termlist)
                 elif self.how_to == MODE['backend']:
                     ham = mb.hamiltonian(self.ham_termlist, self.n_qubits)
+                elif self.how_to in (MODE['matrixfree'], MODE['compressed']):
+                    ham = mb.hamiltonian(self.ham_termlist, self.n_qubits, self.how_to)
                 else:
                     dim = self.sparse_mat.shape[0]
                     nnz = self.sparse_mat.nnz
@@ -127,7 +140,7 @@ class Hamiltonian:
                     ham = mb.hamiltonian(csr_mat, self.n_qubits)
                 self.ham_cpp = ham
             return self.ham_cpp
-        if self.how_to == MODE['backend'] or self.how_to == MODE['origin']:
+        if self.how_to != MODE['frontend']:
             return self.get_cpp_obj()
         if not hasattr(self, 'herm_ham_cpp'):
             herm_sparse_mat = self.sparse_mat.conjugate().T.tocsr()
@@ -0,0 +1,196 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "simulator/adjoint_gradient.hpp"
+#include "simulator/pauli_sum.hpp"
+#include "simulator/types.hpp"
+#include "simulator/utils.hpp"
+
+// =============================================================================
+
+namespace ts = tests::simulator;
+
+using term_t = std::vector<std::pair<unsigned, char>>;
+using hamiltonian_t = std::vector<std::pair<term_t, double>>;
+
+namespace {
+ts::matrix_t pauli_matrix(char op) {
+    const ts::complex_t I(0., 1.);
+    if (op == 'X') {
+        return {0., 1., 1., 0.};
+    }
+    if (op == 'Y') {
+        return {0., -I, I, 0.};
+    }
+    return {1., 0., 0., -1.};
+}
+
+ts::matrix_t kron(const ts::matrix_t& hi, const ts::matrix_t& lo) {
+    ts::matrix_t res(16);
+    for (std::size_t r = 0; r < 4; ++r) {
+        for (std::size_t c = 0; c < 4; ++c) {
+            res[r * 4 + c] = hi[(r >> 1U) * 2 + (c >> 1U)] * lo[(r & 1U) * 2 + (c & 1U)];
+        }
+    }
+    return res;
+}
+
+//! exp(-i theta / 2 P) and its derivative with respect to theta, for a Pauli string P
+std::pair<ts::matrix_t, ts::matrix_t> rotation(const ts::matrix_t& p, double theta) {
+    const ts::complex_t I(0., 1.);
+    const auto dim = p.size() == 4 ? 2U : 4U;
+    const auto c = std::cos(theta / 2.);
+    const auto s = std::sin(theta / 2.);
+    ts::matrix_t u(p.size());
+    ts::matrix_t du(p.size());
+    for (std::size_t k = 0; k < p.size(); ++k) {
+        const auto id = k % (dim + 1) == 0 ? 1. : 0.;
+        u[k] = c * id - I * s * p[k];
+        du[k] = -s / 2. * id - I * c / 2. * p[k];
+    }
+    return {u, du};
+}
+
+//! Rotation gate with angle sum_k weights[k] * params[k]
+adjoint::Gate rotation_gate(const ts::matrix_t& p, const std::vector<std::pair<std::size_t, double>>& weights,
+                            const std::vector<double>& params, ts::index_vector_t ids, ts::index_vector_t ctrls = {}) {
+    double theta = 0.;
+    for (const auto& [k, w] : weights) {
+        theta += w * params[k];
+    }
+    const auto [u, du] = rotation(p, theta);
+
+    adjoint::Gate gate{u, std::move(ids), std::move(ctrls), {}};
+    for (const auto& [k, w] : weights) {
+        auto d = du;
+        for (auto& el : d) {
+            el *= w;
+        }
+        gate.derivatives.emplace_back(k, d);
+    }
+    return gate;
+}
+
+std::vector<adjoint::Gate> make_circuit(const std::vector<double>& params) {
+    const ts::complex_t I(0., 1.);
+    const auto s2 = M_SQRT1_2;
+    return {
+        adjoint::Gate{{s2, s2, s2, -s2}, {0}, {}, {}},
+        rotation_gate(pauli_matrix('X'), {{0, 1.}}, params, {1}, {0}),
+        rotation_gate(pauli_matrix('Y'), {{1, 2.}}, params, {2}),
+        rotation_gate(kron(pauli_matrix('Z'), pauli_matrix('Z')), {{0, 1.}, {2, -1.}}, params, {0, 3}),
+        adjoint::Gate{{1., 0., 0., 0., 0., 0., 0., I, 0., 0., -1., 0., 0., I, 0., 0.}, {3, 1}, {}, {}},
+        rotation_gate(pauli_matrix('Z'), {{2, 1.}}, params, {0}, {2, 3}),
+        rotation_gate(kron(pauli_matrix('X'), pauli_matrix('Y')), {{1, 1.}}, params, {2, 0}),
+        rotation_gate(pauli_matrix('X'), {{0, -0.5}}, params, {3}),
+    };
+}
+
+const hamiltonian_t hamiltonian = {
+    {{{0, 'Z'}}, 0.7},
+    {{{1, 'X'}, {2, 'Y'}}, -1.3},
+    {{{0, 'X'}, {3, 'X'}}, 0.4},
+    {{{2, 'Z'}, {3, 'Y'}}, 0.9},
+    {{}, 0.25},
+};
+
+ts::state_t run_circuit(ts::state_t psi, const std::vector<adjoint::Gate>& circuit) {
+    for (const auto& gate : circuit) {
+        ts::apply_matrix(psi, gate.matrix, gate.ids, gate.ctrls);
+    }
+    return psi;
+}
+}  // namespace
+
+// =============================================================================
+
+TEST_CASE("AdjointGradient/Finite differences", "[adjoint][simulator]") {
+    constexpr auto num_qubits = 4U;
+    const auto seed = GENERATE(range(0U, 4U));
+    INFO("seed = " << seed);
+
+    const auto psi0 = ts::random_state(num_qubits, seed);
+    const pauli::CompiledPauliSum op(hamiltonian, [](unsigned idx) { return idx; });
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+    const std::vector<double> params{angle(rng), angle(rng), angle(rng)};
+
+    const auto circuit = make_circuit(params);
+    const auto psi = run_circuit(psi0, circuit);
+    ts::state_t phi;
+    ts::state_t lambda;
+    const auto res = adjoint::gradient(psi, circuit, op, params.size(), phi, lambda);
+
+    CHECK(res.value == Approx(op.expectation(psi)).margin(1.e-12));
+    REQUIRE(res.gradient.size() == params.size());
+
+    constexpr auto h = 1.e-5;
+    for (std::size_t k = 0; k < params.size(); ++k) {
+        auto plus = params;
+        auto minus = params;
+        plus[k] += h;
+        minus[k] -= h;
+        const auto expected = (op.expectation(run_circuit(psi0, make_circuit(plus)))
+                               - op.expectation(run_circuit(psi0, make_circuit(minus))))
+                              / (2. * h);
+        INFO("k = " << k);
+        CHECK(res.gradient[k] == Approx(expected).margin(1.e-7));
+    }
+}
+
+TEST_CASE("AdjointGradient/Single precision", "[adjoint][simulator]") {
+    const auto psi0 = ts::random_state(4);
+    const pauli::CompiledPauliSum op(hamiltonian, [](unsigned idx) { return idx; });
+    const std::vector<double> params{0.3, -1.2, 2.1};
+
+    const auto circuit = make_circuit(params);
+    const auto psi = run_circuit(psi0, circuit);
+    ts::state_t phi;
+    ts::state_t lambda;
+    const auto expected = adjoint::gradient(psi, circuit, op, params.size(), phi, lambda);
+
+    types::VF psi_f(begin(psi), end(psi));
+    types::VF phi_f;
+    types::VF lambda_f;
+    const auto res = adjoint::gradient(psi_f, circuit, op, params.size(), phi_f, lambda_f);
+
+    CHECK(res.value == Approx(expected.value).margin(1.e-5));
+    for (std::size_t k = 0; k < params.size(); ++k) {
+        CHECK(res.gradient[k] == Approx(expected.gradient[k]).margin(1.e-5));
+    }
+    CHECK(psi_f[3] == std::complex<float>(psi[3]));  // input state left untouched
+}
+
+TEST_CASE("AdjointGradient/Invalid circuits", "[adjoint][simulator]") {
+    const auto psi = ts::random_state(3);
+    const pauli::CompiledPauliSum op(hamiltonian_t{{{{0, 'Z'}}, 1.}}, [](unsigned idx) { return idx; });
+    ts::state_t phi;
+    ts::state_t lambda;
+
+    std::vector<adjoint::Gate> circuit{rotation_gate(pauli_matrix('X'), {{1, 1.}}, {0.1, 0.2}, {0})};
+    CHECK_NOTHROW(adjoint::gradient(psi, circuit, op, 2, phi, lambda));
+    CHECK_THROWS_AS(adjoint::gradient(psi, circuit, op, 1, phi, lambda), std::out_of_range);
+
+    circuit[0].matrix.resize(2);
+    CHECK_THROWS_AS(adjoint::gradient(psi, circuit, op, 2, phi, lambda), std::invalid_argument);
+}
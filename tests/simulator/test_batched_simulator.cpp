@@ -0,0 +1,151 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "simulator/batched_simulator.hpp"
+#include "simulator/pauli_sum.hpp"
+#include "simulator/utils.hpp"
+
+// =============================================================================
+
+namespace ts = tests::simulator;
+
+using batched::BatchedSimulator;
+
+// =============================================================================
+
+TEST_CASE("BatchedSimulator/Initial state", "[batched][simulator]") {
+    BatchedSimulator<> sim(3, 5);
+    CHECK(sim.batch_size() == 5);
+    CHECK(sim.dim() == 8);
+    for (std::size_t b = 0; b < 5; ++b) {
+        auto expected = ts::state_t(8, 0.);
+        expected[0] = 1.;
+        ts::check_states_equal(sim.get_state(b), expected);
+    }
+    CHECK_THROWS_AS(sim.get_state(5), std::out_of_range);
+    CHECK_THROWS_AS(BatchedSimulator<>(3, 0), std::invalid_argument);
+
+    // Invalid target or control qubits
+    const std::vector<ts::matrix_t> x{{0., 1., 1., 0.}};
+    CHECK_THROWS_AS(sim.apply_gate({3}, x), std::invalid_argument);
+    CHECK_THROWS_AS(sim.apply_gate({0}, x, {3}), std::invalid_argument);
+    CHECK_THROWS_AS(sim.apply_gate({1}, x, {1}), std::invalid_argument);
+    CHECK_THROWS_AS(sim.apply_gate({0}, x, {2, 2}), std::invalid_argument);
+    CHECK_THROWS_AS(sim.apply_gate({1, 1}, {ts::matrix_t(16)}), std::invalid_argument);
+    CHECK_NOTHROW(sim.apply_gate({0}, x, {1, 2}));
+}
+
+TEST_CASE("BatchedSimulator/Gates with one matrix per state", "[batched][simulator]") {
+    constexpr auto num_qubits = 7U;
+    constexpr std::size_t batch_size = 6;
+    const auto num_targets = GENERATE(1U, 2U, 3U, 5U);
+    const auto shared = GENERATE(false, true);
+    INFO("num_targets = " << num_targets << ", shared = " << shared);
+
+    std::mt19937 rng(num_targets);
+    BatchedSimulator<> sim(num_qubits, batch_size);
+    std::vector<ts::state_t> expected;
+    for (std::size_t b = 0; b < batch_size; ++b) {
+        expected.push_back(ts::random_state(num_qubits, static_cast<unsigned>(b)));
+        sim.set_state(b, expected.back());
+    }
+
+    for (auto gate = 0; gate < 4; ++gate) {
+        std::vector<unsigned> qubits(num_qubits);
+        std::iota(begin(qubits), end(qubits), 0U);
+        std::shuffle(begin(qubits), end(qubits), rng);
+        const ts::index_vector_t ids(begin(qubits), begin(qubits) + num_targets);
+        const ts::index_vector_t ctrls = gate % 2 == 1 ? ts::index_vector_t{qubits[num_targets]} : ts::index_vector_t{};
+
+        std::vector<ts::matrix_t> matrices;
+        for (std::size_t b = 0; b < (shared ? 1 : batch_size); ++b) {
+            matrices.push_back(ts::random_matrix(num_targets, rng));
+        }
+        sim.apply_gate(std::vector<unsigned>(begin(ids), end(ids)), matrices,
+                       std::vector<unsigned>(begin(ctrls), end(ctrls)));
+        for (std::size_t b = 0; b < batch_size; ++b) {
+            ts::apply_matrix(expected[b], matrices[shared ? 0 : b], ids, ctrls);
+        }
+    }
+
+    for (std::size_t b = 0; b < batch_size; ++b) {
+        ts::check_states_equal(sim.get_state(b), expected[b]);
+    }
+}
+
+TEST_CASE("BatchedSimulator/Rotations and expectation values", "[batched][simulator]") {
+    constexpr auto num_qubits = 4U;
+    constexpr std::size_t batch_size = 9;
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<double> angle(0., 2. * M_PI);
+
+    BatchedSimulator<> sim(num_qubits, batch_size);
+    std::vector<double> thetas(batch_size);
+    for (auto layer = 0; layer < 2; ++layer) {
+        for (unsigned q = 0; q < num_qubits; ++q) {
+            std::generate(begin(thetas), end(thetas), [&] { return angle(rng); });
+            sim.apply_rotation("XYZ"[(q + layer) % 3], q, thetas);
+        }
+        for (unsigned q = 0; q + 1 < num_qubits; ++q) {
+            sim.apply_gate({q + 1}, {{0., 1., 1., 0.}}, {q});
+        }
+    }
+
+    const std::vector<std::pair<std::vector<std::pair<unsigned, char>>, double>> ham{
+        {{}, 0.5}, {{{0, 'Z'}, {1, 'Z'}}, -1.2}, {{{1, 'X'}, {3, 'Y'}}, 0.7}, {{{2, 'Y'}}, 0.3}};
+    const pauli::CompiledPauliSum op(ham, [](unsigned q) { return q; });
+    const auto values = sim.expectation(op);
+    REQUIRE(values.size() == batch_size);
+    for (std::size_t b = 0; b < batch_size; ++b) {
+        const auto psi = sim.get_state(b);
+        CHECK(values[b] == Approx(op.expectation(psi)).margin(1.e-12));
+    }
+
+    // Rotations with a single angle are the expected matrices
+    BatchedSimulator<> single(1, 1);
+    single.apply_rotation('Y', 0, {M_PI});
+    ts::check_states_equal(single.get_state(0), {0., 1.});
+    CHECK_THROWS_AS(single.apply_rotation('A', 0, {0.}), std::invalid_argument);
+}
+
+TEST_CASE("BatchedSimulator/Single precision", "[batched][simulator]") {
+    constexpr auto num_qubits = 5U;
+    constexpr std::size_t batch_size = 16;
+    std::mt19937 rng(8);
+
+    BatchedSimulator<float> sim(num_qubits, batch_size);
+    std::vector<ts::state_t> expected;
+    std::vector<ts::matrix_t> matrices;
+    for (std::size_t b = 0; b < batch_size; ++b) {
+        expected.push_back(ts::random_state(num_qubits, static_cast<unsigned>(b)));
+        sim.set_state(b, expected.back());
+        matrices.push_back(ts::random_matrix(2, rng));
+    }
+    sim.apply_gate({3, 1}, matrices);
+    for (std::size_t b = 0; b < batch_size; ++b) {
+        ts::apply_matrix(expected[b], matrices[b], {3, 1});
+        const auto psi = sim.get_state(b);
+        ts::check_states_equal(ts::state_t(begin(psi), end(psi)), expected[b], 1.e-5);
+    }
+}
@@ -0,0 +1,179 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "simulator/fusion.hpp"
+#include "simulator/utils.hpp"
+
+// =============================================================================
+
+using fusion::Fusion;
+
+namespace ts = tests::simulator;
+
+namespace {
+using item_t = std::pair<ts::matrix_t, ts::index_vector_t>;
+
+//! Random sequence of 1- and 2-qubit gates (without controls) covering all of num_qubits qubits
+auto random_items(unsigned num_qubits, std::size_t num_gates, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<item_t> items;
+    for (std::size_t i = 0; i < num_gates; ++i) {
+        ts::index_vector_t ids{static_cast<unsigned>(i % num_qubits)};
+        if (num_qubits > 1 && rng() % 2 == 0) {
+            auto other = static_cast<unsigned>(rng() % (num_qubits - 1));
+            ids.push_back(other >= ids[0] ? other + 1 : other);
+        }
+        items.emplace_back(ts::random_matrix(ids.size(), rng), ids);
+    }
+    return items;
+}
+
+auto make_fusion(const std::vector<item_t>& items) {
+    Fusion fus;
+    for (const auto& [m, ids] : items) {
+        fus.insert(m, ids);
+    }
+    return fus;
+}
+
+//! Previous implementation of Fusion::perform_fusion(), kept as reference
+auto reference_fusion(const std::vector<item_t>& items) {
+    std::set<unsigned> set;
+    for (const auto& item : items) {
+        set.insert(begin(item.second), end(item.second));
+    }
+    ts::index_vector_t index_list(begin(set), end(set));
+
+    const std::size_t N = index_list.size();
+    const std::size_t dim = 1UL << N;
+    ts::matrix_t M(dim * dim);
+    for (std::size_t i = 0; i < dim; ++i) {
+        M[i * dim + i] = 1.;
+    }
+
+    for (const auto& [mat, idx] : items) {
+        auto dim2 = static_cast<std::size_t>(std::sqrt(mat.size()));
+        ts::index_vector_t idx2mat(idx.size());
+        for (std::size_t i = 0; i < idx.size(); ++i) {
+            idx2mat[i] = static_cast<unsigned>(
+                std::equal_range(index_list.begin(), index_list.end(), idx[i]).first - index_list.begin());
+        }
+
+        for (std::size_t k = 0; k < dim; ++k) {
+            std::vector<ts::complex_t> oldcol(dim);
+            for (std::size_t i = 0; i < dim; ++i) {
+                oldcol[i] = M[i * dim + k];
+            }
+
+            for (std::size_t i = 0; i < dim; ++i) {
+                std::size_t local_i = 0;
+                for (std::size_t l = 0; l < idx.size(); ++l) {
+                    local_i |= ((i >> idx2mat[l]) & 1UL) << l;
+                }
+
+                ts::complex_t res = 0.;
+                for (std::size_t j = 0; j < (1UL << idx.size()); ++j) {
+                    std::size_t locidx = i;
+                    for (std::size_t l = 0; l < idx.size(); ++l) {
+                        if (((j >> l) & 1UL) != ((i >> idx2mat[l]) & 1UL)) {
+                            locidx ^= (1UL << idx2mat[l]);
+                        }
+                    }
+                    res += oldcol[locidx] * mat[local_i * dim2 + j];
+                }
+                M[i * dim + k] = res;
+            }
+        }
+    }
+    return M;
+}
+}  // namespace
+
+// =============================================================================
+
+TEST_CASE("Fusion/PerformFusion", "[fusion][simulator]") {
+    const auto num_qubits = GENERATE(1U, 2U, 3U, 4U, 5U);
+    const auto seed = GENERATE(1U, 2U, 3U);
+    INFO("num_qubits = " << num_qubits << ", seed = " << seed);
+
+    const auto items = random_items(num_qubits, 3 * num_qubits, seed);
+    auto fus = make_fusion(items);
+
+    ts::matrix_t fused;
+    ts::index_vector_t ids;
+    ts::index_vector_t ctrls;
+    fus.perform_fusion(fused, ids, ctrls);
+
+    CHECK(std::size(ids) == num_qubits);
+    CHECK(std::empty(ctrls));
+
+    const auto expected = reference_fusion(items);
+    REQUIRE(std::size(fused) == std::size(expected));
+    for (std::size_t i = 0; i < std::size(fused); ++i) {
+        INFO("i = " << i);
+        CHECK(std::abs(fused[i] - expected[i]) < 1.e-12);
+    }
+}
+
+TEST_CASE("Fusion/PerformFusion with controls", "[fusion][simulator]") {
+    std::mt19937 rng(1234);
+    const ts::index_vector_t ctrls{4};
+    const std::vector<item_t> gates = {{ts::random_matrix(1, rng), {0}},
+                                       {ts::random_matrix(2, rng), {2, 1}},
+                                       {ts::random_matrix(1, rng), {3}}};
+
+    // Controls common to all gates stay global, the others are absorbed in the fused matrix
+    Fusion fus;
+    auto psi_ref = ts::random_state(6);
+    for (const auto& [m, ids] : gates) {
+        fus.insert(m, ids, ctrls);
+        ts::apply_matrix(psi_ref, m, ids, ctrls);
+    }
+    const std::pair<ts::matrix_t, ts::index_vector_t> last = {ts::random_matrix(1, rng), {1}};
+    fus.insert(last.first, last.second, {5});
+    ts::apply_matrix(psi_ref, last.first, last.second, {5});
+
+    auto psi = ts::random_state(6);
+    ts::apply_fusion(psi, fus);
+    ts::check_states_equal(psi, psi_ref);
+}
+
+// =============================================================================
+
+TEST_CASE("Fusion/PerformFusion benchmark", "[.][benchmark][fusion]") {
+    const auto num_qubits = GENERATE(2U, 3U, 4U, 5U);
+    const auto items = random_items(num_qubits, 4 * num_qubits, 42);
+    auto fus = make_fusion(items);
+
+    BENCHMARK("reference N=" + std::to_string(num_qubits)) {
+        return reference_fusion(items);
+    };
+
+    BENCHMARK("in-place N=" + std::to_string(num_qubits)) {
+        ts::matrix_t fused;
+        ts::index_vector_t ids;
+        ts::index_vector_t ctrls;
+        fus.perform_fusion(fused, ids, ctrls);
+        return fused;
+    };
+}
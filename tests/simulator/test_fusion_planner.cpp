@@ -0,0 +1,137 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <random>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "simulator/fusion_planner.hpp"
+#include "simulator/utils.hpp"
+
+// =============================================================================
+
+using fusion::FusionPlanner;
+using fusion::Gate;
+
+namespace ts = tests::simulator;
+
+static const ts::matrix_t X = {0., 1., 1., 0.};
+static const ts::matrix_t Z = {1., 0., 0., -1.};
+static const ts::matrix_t H = {M_SQRT1_2, M_SQRT1_2, M_SQRT1_2, -M_SQRT1_2};
+
+static auto apply_sequentially(ts::state_t psi, const FusionPlanner::GateVector& gates) {
+    for (const auto& gate : gates) {
+        ts::apply_matrix(psi, gate.matrix, gate.targets, gate.controls);
+    }
+    return psi;
+}
+
+static auto apply_planned(ts::state_t psi, const FusionPlanner& planner, const FusionPlanner::GateVector& gates) {
+    auto blocks = planner.plan(gates);
+    for (auto& block : blocks) {
+        ts::apply_fusion(psi, block);
+    }
+    return psi;
+}
+
+// =============================================================================
+
+TEST_CASE("FusionPlanner/Invalid size", "[simulator][fusion]") {
+    CHECK_THROWS_AS(FusionPlanner(0), std::invalid_argument);
+}
+
+TEST_CASE("FusionPlanner/Block size", "[simulator][fusion]") {
+    FusionPlanner::GateVector gates{{H, {0}, {}}, {H, {1}, {}}, {H, {2}, {}}, {H, {3}, {}}};
+
+    SECTION("All in one") {
+        const auto blocks = FusionPlanner(4).plan(gates);
+        REQUIRE(std::size(blocks) == 1);
+        CHECK(blocks[0].num_qubits() == 4);
+    }
+    SECTION("Two blocks") {
+        const auto blocks = FusionPlanner(2).plan(gates);
+        REQUIRE(std::size(blocks) == 2);
+        CHECK(blocks[0].num_qubits() == 2);
+        CHECK(blocks[1].num_qubits() == 2);
+    }
+}
+
+TEST_CASE("FusionPlanner/Commutation", "[simulator][fusion]") {
+    // The Z on qubit 0 commutes with the CNOT(0, 2) (qubit 0 being a control), so that it can be merged with the
+    // first Z on qubit 0 despite the CNOT not fitting in the first block.
+    FusionPlanner::GateVector gates{{Z, {0}, {}}, {H, {1}, {}}, {X, {2}, {0}}, {Z, {0}, {}}};
+    const auto blocks = FusionPlanner(2).plan(gates);
+    REQUIRE(std::size(blocks) == 2);
+    CHECK(blocks[0].size() == 3);
+    CHECK(blocks[1].size() == 1);
+
+    const auto psi = ts::random_state(3);
+    ts::check_states_equal(apply_sequentially(psi, gates), apply_planned(psi, FusionPlanner(2), gates));
+}
+
+TEST_CASE("FusionPlanner/No illegal reordering", "[simulator][fusion]") {
+    // H on qubit 0 does not commute with the CNOT(0, 2) so it cannot be moved into the first block
+    FusionPlanner::GateVector gates{{Z, {0}, {}}, {H, {1}, {}}, {X, {2}, {0}}, {H, {0}, {}}};
+    const auto blocks = FusionPlanner(2).plan(gates);
+    REQUIRE(std::size(blocks) == 2);
+    CHECK(blocks[0].size() == 2);
+    CHECK(blocks[1].size() == 2);
+
+    const auto psi = ts::random_state(3);
+    ts::check_states_equal(apply_sequentially(psi, gates), apply_planned(psi, FusionPlanner(2), gates));
+}
+
+TEST_CASE("FusionPlanner/Random circuits", "[simulator][fusion]") {
+    constexpr auto num_qubits = 6U;
+    constexpr auto num_gates = 60U;
+    const auto max_qubits = GENERATE(1U, 2U, 3U, 4U, 5U);
+
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<unsigned> qubit_dist(0, num_qubits - 1);
+    std::uniform_int_distribution<unsigned> kind_dist(0, 3);
+
+    FusionPlanner::GateVector gates;
+    while (std::size(gates) < num_gates) {
+        const auto q0 = qubit_dist(rng);
+        const auto q1 = qubit_dist(rng);
+        switch (kind_dist(rng)) {
+            case 0:
+                gates.push_back({ts::random_matrix(1, rng), {q0}, {}});
+                break;
+            case 1:
+                gates.push_back({Z, {q0}, {}});
+                break;
+            case 2:
+                if (q0 != q1) {
+                    gates.push_back({X, {q0}, {q1}});
+                }
+                break;
+            default:
+                if (q0 != q1 && max_qubits > 1) {
+                    gates.push_back({ts::random_matrix(2, rng), {q0, q1}, {}});
+                }
+                break;
+        }
+    }
+
+    const FusionPlanner planner(max_qubits);
+    const auto blocks = planner.plan(gates);
+    for (const auto& block : blocks) {
+        CHECK(block.num_qubits() <= max_qubits);
+    }
+
+    const auto psi = ts::random_state(num_qubits);
+    ts::check_states_equal(apply_sequentially(psi, gates), apply_planned(psi, planner, gates), 1.e-8);
+}
@@ -0,0 +1,196 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+// clang-format off
+#include "simulator/cintrin.hpp"
+#include "simulator/dispatch.hpp"
+#include "simulator/types.hpp"
+#if defined(INTRIN) && !defined(NOINTRIN)
+#    include "simulator/_cppkernels/vector/kernel1.hpp"
+#    include "simulator/_cppkernels/vector/kernel2.hpp"
+#    include "simulator/_cppkernels/vector/kernel3.hpp"
+#    include "simulator/_cppkernels/vector/kernel4.hpp"
+#    include "simulator/_cppkernels/vector/kernel5.hpp"
+#else
+#    include "simulator/_cppkernels/scalar/kernel1.hpp"
+#    include "simulator/_cppkernels/scalar/kernel2.hpp"
+#    include "simulator/_cppkernels/scalar/kernel3.hpp"
+#    include "simulator/_cppkernels/scalar/kernel4.hpp"
+#    include "simulator/_cppkernels/scalar/kernel5.hpp"
+#endif  // INTRIN && !NOINTRIN
+// clang-format on
+
+#include "simulator/utils.hpp"
+
+// =============================================================================
+
+namespace ts = tests::simulator;
+
+using types::M;
+using types::UINT;
+using types::V;
+using types::VF;
+
+namespace {
+template <int CTRLMASK, class state_vector_t>
+void dispatch(state_vector_t& psi, const M& m, UINT ctrlmask, const ts::index_vector_t& ids) {
+    switch (ids.size()) {
+        case 1:
+            details::kernel1::dispatch<state_vector_t, M, UINT, CTRLMASK>(psi, m, ctrlmask, ids.data());
+            break;
+        case 2:
+            details::kernel2::dispatch<state_vector_t, M, UINT, CTRLMASK>(psi, m, ctrlmask, ids.data());
+            break;
+        case 3:
+            details::kernel3::dispatch<state_vector_t, M, UINT, CTRLMASK>(psi, m, ctrlmask, ids.data());
+            break;
+        case 4:
+            details::kernel4::dispatch<state_vector_t, M, UINT, CTRLMASK>(psi, m, ctrlmask, ids.data());
+            break;
+        case 5:
+            details::kernel5::dispatch<state_vector_t, M, UINT, CTRLMASK>(psi, m, ctrlmask, ids.data());
+            break;
+        default:
+            FAIL("Unsupported number of qubits");
+    }
+}
+
+template <class state_vector_t>
+void apply_kernel(state_vector_t& psi, const M& m, const ts::index_vector_t& ids, const ts::index_vector_t& ctrls) {
+    UINT ctrlmask = 0;
+    for (auto ctrl : ctrls) {
+        ctrlmask |= UINT(1) << ctrl;
+    }
+    if (ctrlmask == 0) {
+        dispatch<0>(psi, m, ctrlmask, ids);
+    } else {
+        dispatch<1>(psi, m, ctrlmask, ids);
+    }
+}
+}  // namespace
+
+// =============================================================================
+
+TEST_CASE("Kernels/Dense kernels with controls", "[kernels][simulator]") {
+    constexpr auto num_qubits = 9U;
+    const auto num_targets = GENERATE(1U, 2U, 3U, 4U, 5U);
+    const auto num_ctrls = GENERATE(0U, 1U, 2U, 4U);
+    const auto seed = GENERATE(range(0U, 4U));
+    INFO("num_targets = " << num_targets << ", num_ctrls = " << num_ctrls << ", seed = " << seed);
+
+    std::mt19937 rng(seed);
+    std::vector<unsigned> qubits(num_qubits);
+    std::iota(begin(qubits), end(qubits), 0U);
+    std::shuffle(begin(qubits), end(qubits), rng);
+
+    const ts::index_vector_t ids(begin(qubits), begin(qubits) + num_targets);
+    const ts::index_vector_t ctrls(begin(qubits) + num_targets, begin(qubits) + num_targets + num_ctrls);
+    const auto m = ts::random_matrix(num_targets, rng);
+
+    auto expected = ts::random_state(num_qubits, seed);
+    V psi(begin(expected), end(expected));
+    ts::apply_matrix(expected, m, ids, ctrls);
+    apply_kernel(psi, m, ids, ctrls);
+
+    ts::check_states_equal(ts::state_t(begin(psi), end(psi)), expected);
+}
+
+TEST_CASE("Kernels/All qubits used as targets or controls", "[kernels][simulator]") {
+    std::mt19937 rng(42);
+    const ts::index_vector_t ids{3, 0};
+    const ts::index_vector_t ctrls{1, 2};
+    const auto m = ts::random_matrix(2, rng);
+
+    auto expected = ts::random_state(4);
+    V psi(begin(expected), end(expected));
+    ts::apply_matrix(expected, m, ids, ctrls);
+    apply_kernel(psi, m, ids, ctrls);
+
+    ts::check_states_equal(ts::state_t(begin(psi), end(psi)), expected);
+}
+
+TEST_CASE("Kernels/Single precision", "[kernels][simulator]") {
+    constexpr auto num_qubits = 8U;
+    const auto num_targets = GENERATE(1U, 2U, 3U, 4U, 5U);
+    const auto num_ctrls = GENERATE(0U, 1U);
+    const auto seed = GENERATE(range(0U, 3U));
+    INFO("num_targets = " << num_targets << ", num_ctrls = " << num_ctrls << ", seed = " << seed);
+
+    std::mt19937 rng(seed);
+    std::vector<unsigned> qubits(num_qubits);
+    std::iota(begin(qubits), end(qubits), 0U);
+    std::shuffle(begin(qubits), end(qubits), rng);
+
+    const ts::index_vector_t ids(begin(qubits), begin(qubits) + num_targets);
+    const ts::index_vector_t ctrls(begin(qubits) + num_targets, begin(qubits) + num_targets + num_ctrls);
+    const auto m = ts::random_matrix(num_targets, rng);
+
+    auto expected = ts::random_state(num_qubits, seed);
+    VF psi(begin(expected), end(expected));
+    ts::apply_matrix(expected, m, ids, ctrls);
+    apply_kernel(psi, m, ids, ctrls);
+
+    ts::check_states_equal(ts::state_t(begin(psi), end(psi)), expected, 1.e-5);
+}
+
+// =============================================================================
+
+TEST_CASE("Kernels/Loop index type selection", "[kernels][simulator]") {
+    CHECK(details::loop_index_bytes(0) == 1);
+    CHECK(details::loop_index_bytes(8) == 1);
+    CHECK(details::loop_index_bytes(9) == 2);
+    CHECK(details::loop_index_bytes(16) == 2);
+    CHECK(details::loop_index_bytes(17) == 4);
+    CHECK(details::loop_index_bytes(32) == 4);
+
+    // Boundary of the former 4-byte limit (states with more than 2^(32 + N) amplitudes)
+    CHECK(details::loop_index_bytes(33) == 8);
+    CHECK(details::loop_index_bytes(64) == 8);
+    CHECK_THROWS_AS(details::loop_index_bytes(65), std::overflow_error);
+}
+
+TEST_CASE("Kernels/64-bit loop index", "[kernels][simulator]") {
+    // NB: states large enough to require a 64-bit loop index do not fit in the memory of a CI machine, so force the
+    //     type of the loop index instead.
+    constexpr auto num_qubits = 8U;
+    const auto with_ctrl = GENERATE(false, true);
+    INFO("with_ctrl = " << with_ctrl);
+
+    std::mt19937 rng(7);
+    const ts::index_vector_t ids{5, 1};
+    const ts::index_vector_t ctrls = with_ctrl ? ts::index_vector_t{3} : ts::index_vector_t{};
+    const UINT ctrlmask = with_ctrl ? UINT(1) << 3U : UINT(0);
+    const auto m = ts::random_matrix(2, rng);
+
+    auto expected = ts::random_state(num_qubits);
+    V psi(begin(expected), end(expected));
+    ts::apply_matrix(expected, m, ids, ctrls);
+    if (with_ctrl) {
+        kernel_dispatch<2, details::kernel2, 1, V, M, UINT, uint64_t>(psi, m, ctrlmask, ids.data());
+    } else {
+        kernel_dispatch<2, details::kernel2, 0, V, M, UINT, uint64_t>(psi, m, ctrlmask, ids.data());
+    }
+
+    ts::check_states_equal(ts::state_t(begin(psi), end(psi)), expected);
+}
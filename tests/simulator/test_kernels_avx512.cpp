@@ -0,0 +1,146 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+// clang-format off
+#include "simulator/cintrin.hpp"
+#include "simulator/dispatch.hpp"
+#include "simulator/types.hpp"
+#include "simulator/_cppkernels/vector/kernel1.hpp"
+#include "simulator/_cppkernels/vector/kernel2.hpp"
+#include "simulator/_cppkernels/vector/kernel3.hpp"
+#include "simulator/_cppkernels/vector/kernel4.hpp"
+#include "simulator/_cppkernels/vector/kernel5.hpp"
+#include "simulator/_cppkernels/vector_avx512/utils.hpp"
+// clang-format on
+
+#include "simulator/utils.hpp"
+
+// =============================================================================
+
+namespace ts = tests::simulator;
+
+using types::M;
+using types::UINT;
+using types::V;
+
+namespace {
+template <typename func_t>
+void with_kernels(unsigned num_targets, func_t&& func) {
+    // NB: the AVX-512 family uses the AVX2 kernel for single-qubit gates
+    switch (num_targets) {
+        case 1:
+            func(std::integral_constant<int, 1>{}, details::kernel1{}, details::kernel1{});
+            break;
+        case 2:
+            func(std::integral_constant<int, 2>{}, details::kernel2{}, details::avx512::kernel<2>{});
+            break;
+        case 3:
+            func(std::integral_constant<int, 3>{}, details::kernel3{}, details::avx512::kernel<3>{});
+            break;
+        case 4:
+            func(std::integral_constant<int, 4>{}, details::kernel4{}, details::avx512::kernel<4>{});
+            break;
+        case 5:
+            func(std::integral_constant<int, 5>{}, details::kernel5{}, details::avx512::kernel<5>{});
+            break;
+        default:
+            FAIL("Unsupported number of qubits");
+    }
+}
+
+bool has_avx512() {
+    return __builtin_cpu_supports("avx512f") != 0;
+}
+}  // namespace
+
+// =============================================================================
+
+TEST_CASE("KernelsAVX512/Dense kernels", "[kernels][avx512][simulator]") {
+    if (!has_avx512()) {
+        WARN("AVX-512 not supported by the CPU, skipping");
+        return;
+    }
+
+    constexpr auto num_qubits = 9U;
+    const auto num_targets = GENERATE(2U, 3U, 4U, 5U);
+    const auto num_ctrls = GENERATE(0U, 2U);
+    const auto seed = GENERATE(range(0U, 4U));
+    INFO("num_targets = " << num_targets << ", num_ctrls = " << num_ctrls << ", seed = " << seed);
+
+    std::mt19937 rng(seed);
+    std::vector<unsigned> qubits(num_qubits);
+    std::iota(begin(qubits), end(qubits), 0U);
+    std::shuffle(begin(qubits), end(qubits), rng);
+
+    const ts::index_vector_t ids(begin(qubits), begin(qubits) + num_targets);
+    const ts::index_vector_t ctrls(begin(qubits) + num_targets, begin(qubits) + num_targets + num_ctrls);
+    UINT ctrlmask = 0;
+    for (auto ctrl : ctrls) {
+        ctrlmask |= UINT(1) << ctrl;
+    }
+    const auto m = ts::random_matrix(num_targets, rng);
+
+    auto expected = ts::random_state(num_qubits, seed);
+    V psi(begin(expected), end(expected));
+    ts::apply_matrix(expected, m, ids, ctrls);
+    with_kernels(num_targets, [&](auto n, auto /* avx2 */, auto avx512) {
+        using kernel_t = decltype(avx512);
+        if (ctrlmask == 0) {
+            kernel_dispatch<decltype(n)::value, kernel_t, 0>(psi, m, ctrlmask, ids.data());
+        } else {
+            kernel_dispatch<decltype(n)::value, kernel_t, 1>(psi, m, ctrlmask, ids.data());
+        }
+    });
+
+    ts::check_states_equal(ts::state_t(begin(psi), end(psi)), expected);
+}
+
+// =============================================================================
+
+TEST_CASE("KernelsAVX512/AVX2 vs AVX-512 benchmark", "[.][benchmark][avx512]") {
+    if (!has_avx512()) {
+        WARN("AVX-512 not supported by the CPU, skipping");
+        return;
+    }
+
+    constexpr auto num_qubits = 20U;
+    const auto num_targets = GENERATE(1U, 2U, 3U, 4U, 5U);
+
+    std::mt19937 rng(42);
+    ts::index_vector_t ids(num_targets);
+    std::iota(begin(ids), end(ids), 3U);
+    const auto m = ts::random_matrix(num_targets, rng);
+    const auto init = ts::random_state(num_qubits);
+    V psi(begin(init), end(init));
+
+    with_kernels(num_targets, [&](auto n, auto avx2, auto avx512) {
+        BENCHMARK("AVX2 N=" + std::to_string(num_targets)) {
+            kernel_dispatch<decltype(n)::value, decltype(avx2), 0>(psi, m, UINT(0), ids.data());
+            return psi[0];
+        };
+        BENCHMARK("AVX-512 N=" + std::to_string(num_targets)) {
+            kernel_dispatch<decltype(n)::value, decltype(avx512), 0>(psi, m, UINT(0), ids.data());
+            return psi[0];
+        };
+    });
+}
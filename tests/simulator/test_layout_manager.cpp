@@ -0,0 +1,128 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "simulator/layout_manager.hpp"
+#include "simulator/utils.hpp"
+
+// =============================================================================
+
+using layout::LayoutManager;
+
+namespace ts = tests::simulator;
+
+namespace {
+auto identity_map(unsigned num_qubits) {
+    LayoutManager::Map map;
+    for (unsigned i = 0; i < num_qubits; ++i) {
+        map[i] = i;
+    }
+    return map;
+}
+
+//! Amplitude of a logical basis state given the logical -> physical mapping
+auto amplitude(const ts::state_t& psi, const LayoutManager::Map& map, std::size_t logical_index) {
+    std::size_t index = 0;
+    for (const auto& [id, pos] : map) {
+        index |= ((logical_index >> id) & 1U) << pos;
+    }
+    return psi[index];
+}
+}  // namespace
+
+// =============================================================================
+
+TEST_CASE("LayoutManager/Constructor", "[layout][simulator]") {
+    CHECK_THROWS_AS(LayoutManager(0), std::invalid_argument);
+    CHECK_THROWS_AS(LayoutManager(1, 0), std::invalid_argument);
+    CHECK_NOTHROW(LayoutManager(1, 1));
+}
+
+TEST_CASE("LayoutManager/Swap to low", "[layout][simulator]") {
+    constexpr auto period = 16U;
+    LayoutManager manager(period, 2, 4);
+    const auto map = identity_map(6);
+
+    // Qubits 5 and 4 are the most used, qubit 0 is somewhat used, qubit 1 is never used
+    for (auto i = 0U; i < period; ++i) {
+        CHECK(!manager.due());
+        if (i % 4 == 0) {
+            manager.record(std::vector<unsigned>{0});
+        } else {
+            manager.record(std::vector<unsigned>{5, 4});
+        }
+    }
+    REQUIRE(manager.due());
+
+    const auto perm = manager.plan(map);
+    REQUIRE(std::size(perm) == 6);
+    CHECK(!manager.due());
+    CHECK(manager.num_reorders() == 1);
+
+    // Qubits 5 and 4 now in the two lowest bits
+    CHECK(perm[5] < 2);
+    CHECK(perm[4] < 2);
+    CHECK(perm[2] == 2);
+    CHECK(perm[3] == 3);
+    CHECK(std::is_permutation(begin(perm), end(perm), std::vector<unsigned>{0, 1, 2, 3, 4, 5}.begin()));
+}
+
+TEST_CASE("LayoutManager/Keep layout", "[layout][simulator]") {
+    SECTION("Already low") {
+        LayoutManager manager(4, 2, 1);
+        for (auto i = 0U; i < 4; ++i) {
+            manager.record(std::vector<unsigned>{0, 1});
+        }
+        CHECK(std::empty(manager.plan(identity_map(5))));
+    }
+    SECTION("Not enough gain") {
+        LayoutManager manager(4, 2, 8);
+        for (auto i = 0U; i < 4; ++i) {
+            manager.record(std::vector<unsigned>{4});
+        }
+        CHECK(std::empty(manager.plan(identity_map(5))));
+        CHECK(manager.num_reorders() == 0);
+    }
+    SECTION("Fewer qubits than low qubits") {
+        LayoutManager manager(1, 10, 0);
+        manager.record(std::vector<unsigned>{3});
+        CHECK(std::empty(manager.plan(identity_map(4))));
+    }
+}
+
+TEST_CASE("LayoutManager/Permute state vector", "[layout][simulator]") {
+    constexpr auto num_qubits = 11U;
+    const LayoutManager::Permutation perm = {3, 10, 0, 7, 1, 2, 9, 4, 5, 8, 6};
+    auto map = identity_map(num_qubits);
+
+    const auto psi = ts::random_state(num_qubits);
+    ts::state_t permuted(psi.size());
+    LayoutManager::permute(psi, permuted, perm);
+
+    auto new_map = map;
+    for (auto& p : new_map) {
+        p.second = perm[p.second];
+    }
+
+    for (std::size_t i = 0; i < psi.size(); ++i) {
+        CHECK(amplitude(permuted, new_map, i) == amplitude(psi, map, i));
+    }
+}
@@ -0,0 +1,257 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <complex>
+#include <cstddef>
+#include <numeric>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "simulator/pauli_expectation.hpp"
+#include "simulator/pauli_grouping.hpp"
+#include "simulator/types.hpp"
+#include "simulator/utils.hpp"
+
+// =============================================================================
+
+namespace ts = tests::simulator;
+
+using term_t = std::vector<std::pair<unsigned, char>>;
+
+namespace {
+//! Reference value of Re(<psi|P|psi>), applying the Pauli operators of the term one after the other
+double reference(const ts::state_t& psi, const term_t& term) {
+    const ts::complex_t I(0., 1.);
+    auto phi = psi;
+    for (const auto& [qubit, op] : term) {
+        ts::matrix_t m;
+        if (op == 'X') {
+            m = {0., 1., 1., 0.};
+        } else if (op == 'Y') {
+            m = {0., -I, I, 0.};
+        } else {
+            m = {1., 0., 0., -1.};
+        }
+        ts::apply_matrix(phi, m, {qubit});
+    }
+    ts::complex_t res = 0.;
+    for (std::size_t i = 0; i < psi.size(); ++i) {
+        res += std::conj(psi[i]) * phi[i];
+    }
+    return res.real();
+}
+
+term_t random_term(unsigned num_qubits, std::mt19937& rng) {
+    std::uniform_int_distribution<unsigned> qubit(0, num_qubits - 1);
+    std::uniform_int_distribution<unsigned> length(0, 5);
+    std::uniform_int_distribution<int> op(0, 2);
+    term_t term(length(rng));
+    for (auto& local_op : term) {
+        local_op = {qubit(rng), static_cast<char>('X' + op(rng))};
+    }
+    return term;
+}
+
+auto identity = [](unsigned qubit) { return qubit; };
+}  // namespace
+
+// =============================================================================
+
+TEST_CASE("PauliExpectation/Masks", "[pauli][simulator]") {
+    const auto mask = pauli::make_pauli_mask(term_t{{0, 'X'}, {2, 'Y'}, {3, 'Z'}}, identity);
+    CHECK(mask.mask_x == 0b0001);
+    CHECK(mask.mask_y == 0b0100);
+    CHECK(mask.mask_z == 0b1000);
+    CHECK(mask.num_y == 1);
+    CHECK(mask.phase == 0);
+
+    // Y * X = -i Z
+    const auto product = pauli::make_pauli_mask(term_t{{1, 'X'}, {1, 'Y'}}, identity);
+    CHECK(product.flip_mask() == 0);
+    CHECK(product.mask_z == 0b10);
+    CHECK(product.phase == 3);
+
+    // X * X = I
+    const auto id = pauli::make_pauli_mask(term_t{{1, 'X'}, {1, 'X'}}, identity);
+    CHECK(id.flip_mask() == 0);
+    CHECK(id.sign_mask() == 0);
+
+    // Qubit mapping
+    const auto mapped = pauli::make_pauli_mask(term_t{{0, 'Z'}}, [](unsigned q) { return q + 3; });
+    CHECK(mapped.mask_z == 0b1000);
+
+    CHECK_THROWS_AS(pauli::make_pauli_mask(term_t{{0, 'A'}}, identity), std::invalid_argument);
+}
+
+TEST_CASE("PauliExpectation/Batch of terms", "[pauli][simulator]") {
+    // NB: 14 qubits so that some flipped qubits are located above the tiles
+    const auto num_qubits = GENERATE(3U, 14U);
+    const auto seed = GENERATE(range(0U, 3U));
+    INFO("num_qubits = " << num_qubits << ", seed = " << seed);
+
+    std::mt19937 rng(seed);
+    const auto psi = ts::random_state(num_qubits, seed);
+
+    std::vector<term_t> terms{{}, {{num_qubits - 1, 'X'}, {0, 'Y'}}, {{num_qubits - 1, 'Y'}, {1, 'Z'}}};
+    for (auto t = 0; t < 40; ++t) {
+        terms.push_back(random_term(num_qubits, rng));
+    }
+    // Terms sharing the same flip mask
+    terms.push_back({{1, 'X'}, {2, 'Z'}});
+    terms.push_back({{1, 'X'}, {0, 'Z'}});
+    terms.push_back({{1, 'Y'}});
+
+    std::vector<pauli::PauliMask> masks;
+    for (const auto& term : terms) {
+        masks.push_back(pauli::make_pauli_mask(term, identity));
+    }
+    const auto values = pauli::expectation_values(psi, masks);
+    REQUIRE(values.size() == terms.size());
+    for (std::size_t t = 0; t < terms.size(); ++t) {
+        INFO("term #" << t);
+        CHECK(values[t] == Approx(reference(psi, terms[t])).margin(1.e-10));
+    }
+}
+
+TEST_CASE("PauliExpectation/Single precision", "[pauli][simulator]") {
+    constexpr auto num_qubits = 6U;
+    std::mt19937 rng(5);
+    const auto psi = ts::random_state(num_qubits, 5);
+    const types::VF psi_float(begin(psi), end(psi));
+
+    std::vector<term_t> terms;
+    std::vector<pauli::PauliMask> masks;
+    for (auto t = 0; t < 10; ++t) {
+        terms.push_back(random_term(num_qubits, rng));
+        masks.push_back(pauli::make_pauli_mask(terms.back(), identity));
+    }
+    const auto values = pauli::expectation_values(psi_float, masks);
+    for (std::size_t t = 0; t < terms.size(); ++t) {
+        CHECK(values[t] == Approx(reference(psi, terms[t])).margin(1.e-5));
+    }
+}
+
+// =============================================================================
+
+TEST_CASE("PauliGrouping/Qubit-wise commuting groups", "[pauli][simulator]") {
+    std::mt19937 rng(3);
+    std::vector<pauli::PauliMask> masks;
+    for (auto t = 0; t < 100; ++t) {
+        masks.push_back(pauli::make_pauli_mask(random_term(8, rng), identity));
+    }
+    const auto grouping = pauli::group_qubit_wise(masks);
+    CHECK(grouping.groups.size() < masks.size());
+
+    std::set<std::size_t> seen;
+    for (const auto& group : grouping.groups) {
+        // The basis of the group is consistent on each qubit
+        CHECK((group.mask_x & group.mask_y) == 0);
+        CHECK((group.mask_x & group.mask_z) == 0);
+        CHECK((group.mask_y & group.mask_z) == 0);
+        for (auto t : group.terms) {
+            CHECK((masks[t].mask_x & ~group.mask_x) == 0);
+            CHECK((masks[t].mask_y & ~group.mask_y) == 0);
+            CHECK((masks[t].mask_z & ~group.mask_z) == 0);
+            CHECK(seen.insert(t).second);
+        }
+    }
+    CHECK(seen.size() == masks.size());
+
+    const auto remapped = pauli::remap(grouping, [](unsigned p) { return 7U - p; });
+    CHECK(remapped.groups.size() == grouping.groups.size());
+    const auto mask = pauli::make_pauli_mask(term_t{{0, 'X'}, {6, 'Z'}}, identity);
+    const auto single = pauli::remap(pauli::group_qubit_wise({mask}), [](unsigned p) { return 7U - p; });
+    CHECK(single.masks[0].mask_x == 0b10000000);
+    CHECK(single.masks[0].mask_z == 0b00000010);
+    CHECK(single.groups[0].mask_x == 0b10000000);
+}
+
+TEST_CASE("PauliGrouping/Grouped expectation values", "[pauli][simulator]") {
+    // NB: with 14 qubits, some groups act on too many qubits for the histogram-based diagonal sweep
+    const auto num_qubits = GENERATE(3U, 14U);
+    const auto seed = GENERATE(range(0U, 3U));
+    INFO("num_qubits = " << num_qubits << ", seed = " << seed);
+
+    std::mt19937 rng(seed);
+    const auto psi = ts::random_state(num_qubits, seed);
+
+    std::vector<term_t> terms{{}, {{0, 'Z'}, {1, 'Z'}}, {{num_qubits - 1, 'Y'}, {0, 'X'}}};
+    for (auto t = 0; t < 40; ++t) {
+        terms.push_back(random_term(num_qubits, rng));
+    }
+    std::vector<pauli::PauliMask> masks;
+    for (const auto& term : terms) {
+        masks.push_back(pauli::make_pauli_mask(term, identity));
+    }
+
+    const auto grouping = pauli::group_qubit_wise(masks);
+    ts::state_t workspace;
+    const auto values = pauli::grouped_expectation_values(psi, grouping, workspace);
+    REQUIRE(values.size() == terms.size());
+    for (std::size_t t = 0; t < terms.size(); ++t) {
+        INFO("term #" << t);
+        CHECK(values[t] == Approx(reference(psi, terms[t])).margin(1.e-10));
+    }
+}
+
+TEST_CASE("PauliGrouping/High-weight groups", "[pauli][simulator]") {
+    // NB: up to 12 rotated qubits, i.e. several blocked basis changes per group
+    constexpr auto num_qubits = 13U;
+    const auto num_rotated = GENERATE(4U, 5U, 6U, 11U, 12U);
+    const auto seed = GENERATE(range(0U, 3U));
+    INFO("num_rotated = " << num_rotated << ", seed = " << seed);
+
+    std::mt19937 rng(seed);
+    const auto psi = ts::random_state(num_qubits, seed);
+
+    // All the terms share the same X/Y basis on num_rotated qubits (in random order), with Z or I elsewhere
+    std::vector<unsigned> qubits(num_qubits);
+    std::iota(begin(qubits), end(qubits), 0U);
+    std::shuffle(begin(qubits), end(qubits), rng);
+    term_t basis;
+    for (auto k = 0U; k < num_rotated; ++k) {
+        basis.emplace_back(qubits[k], rng() % 2 == 0 ? 'X' : 'Y');
+    }
+
+    std::vector<term_t> terms;
+    for (auto t = 0; t < 6; ++t) {
+        auto term = basis;
+        for (auto k = num_rotated; k < num_qubits; ++k) {
+            if (rng() % 2 == 0) {
+                term.emplace_back(qubits[k], 'Z');
+            }
+        }
+        if (t % 2 == 1) {
+            term.pop_back();
+        }
+        terms.push_back(term);
+    }
+    std::vector<pauli::PauliMask> masks;
+    for (const auto& term : terms) {
+        masks.push_back(pauli::make_pauli_mask(term, identity));
+    }
+
+    const auto grouping = pauli::group_qubit_wise(masks);
+    REQUIRE(grouping.groups.size() == 1);
+    ts::state_t workspace;
+    const auto values = pauli::grouped_expectation_values(psi, grouping, workspace);
+    for (std::size_t t = 0; t < terms.size(); ++t) {
+        INFO("term #" << t);
+        CHECK(values[t] == Approx(reference(psi, terms[t])).margin(1.e-10));
+    }
+}
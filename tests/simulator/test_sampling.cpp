@@ -0,0 +1,163 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "simulator/sampling.hpp"
+#include "simulator/utils.hpp"
+
+// =============================================================================
+
+namespace ts = tests::simulator;
+
+using sampling::Sampler;
+
+namespace {
+//! Marginal distribution of the qubits located at positions (bit i of the outcome <-> positions[i])
+std::vector<double> marginal(const ts::state_t& psi, const std::vector<unsigned>& positions) {
+    std::vector<double> probs(std::size_t(1) << positions.size(), 0.);
+    for (std::size_t i = 0; i < psi.size(); ++i) {
+        std::size_t bin = 0;
+        for (std::size_t k = 0; k < positions.size(); ++k) {
+            bin |= ((i >> positions[k]) & 1U) << k;
+        }
+        probs[bin] += std::norm(psi[i]);
+    }
+    return probs;
+}
+}  // namespace
+
+// =============================================================================
+
+TEST_CASE("Sampler/Cumulative probabilities", "[sampling][simulator]") {
+    // NB: 17 qubits so that the prefix sum spans several chunks
+    const auto num_qubits = GENERATE(4U, 17U);
+    const auto positions = GENERATE(std::vector<unsigned>{}, std::vector<unsigned>{2, 0},
+                                    std::vector<unsigned>{3, 1, 0, 2});
+    INFO("num_qubits = " << num_qubits << ", num_measured = " << positions.size());
+
+    const auto psi = ts::random_state(num_qubits);
+    const Sampler sampler(psi, positions);
+
+    // All the qubits measured: one entry per amplitude
+    const auto num_entries = positions.size() + 2 > num_qubits ? psi.size() : std::size_t(1) << positions.size();
+    REQUIRE(sampler.cdf().size() == num_entries);
+    CHECK(sampler.total() == Approx(1.));
+
+    if (num_entries < psi.size()) {
+        const auto probs = marginal(psi, positions);
+        std::vector<double> expected(probs.size());
+        std::partial_sum(begin(probs), end(probs), begin(expected));
+        for (std::size_t b = 0; b < expected.size(); ++b) {
+            CHECK(sampler.cdf()[b] == Approx(expected[b]));
+        }
+    } else {
+        double sum = 0.;
+        for (std::size_t i = 0; i < psi.size(); ++i) {
+            sum += std::norm(psi[i]);
+            CHECK(sampler.cdf()[i] == Approx(sum));
+        }
+    }
+}
+
+TEST_CASE("Sampler/Single outcome", "[sampling][simulator]") {
+    // |psi> = |101> on qubits (2, 1, 0)
+    ts::state_t psi(8);
+    psi[5] = 1.;
+
+    CHECK(Sampler(psi, {0, 1, 2}).sample(0.) == 5);
+    CHECK(Sampler(psi, {0, 1, 2}).sample(0.999) == 5);
+    CHECK(Sampler(psi, {2, 0}).sample(0.5) == 3);
+    CHECK(Sampler(psi, {1}).sample(0.5) == 0);
+
+    std::mt19937 rng(1);
+    for (auto method : {Sampler::Method::binary_search, Sampler::Method::sorted_sweep}) {
+        for (auto outcome : Sampler(psi, {2, 1}).sample(100, rng, method)) {
+            CHECK(outcome == 1);
+        }
+    }
+
+    CHECK_THROWS(Sampler(ts::state_t(8), {0}));
+    CHECK_THROWS(Sampler(psi, {3}));
+}
+
+TEST_CASE("Sampler/Single shot without table", "[sampling][simulator]") {
+    // |psi> = |101> on qubits (2, 1, 0)
+    ts::state_t single(8);
+    single[5] = 1.;
+    CHECK(sampling::sample_once(single, {0, 1, 2}, 0.) == 5);
+    CHECK(sampling::sample_once(single, {0, 1, 2}, 0.999) == 5);
+    CHECK(sampling::sample_once(single, {2, 0}, 0.5) == 3);
+    CHECK(sampling::sample_once(single, {1}, 0.5) == 0);
+    CHECK_THROWS(sampling::sample_once(ts::state_t(8), {0}, 0.5));
+    CHECK_THROWS(sampling::sample_once(single, {3}, 0.5));
+
+    // NB: 17 qubits so that the search spans several chunks
+    const auto positions = GENERATE(std::vector<unsigned>{16, 3}, std::vector<unsigned>{0, 4, 8, 12, 16});
+    INFO("num_measured = " << positions.size());
+    auto psi = ts::random_state(17, 5);
+    std::fill(begin(psi) + 3 * sampling::chunk_size, begin(psi) + 5 * sampling::chunk_size, 0.);
+
+    // Reference: cumulative probabilities in the order of the amplitudes
+    std::vector<double> cdf(psi.size());
+    double sum = 0.;
+    for (std::size_t i = 0; i < psi.size(); ++i) {
+        sum += std::norm(psi[i]);
+        cdf[i] = sum;
+    }
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> dist(0., 1.);
+    for (auto s = 0; s < 200; ++s) {
+        const auto u = dist(rng);
+        const auto idx = std::upper_bound(begin(cdf), end(cdf), u * sum) - begin(cdf);
+        INFO("u = " << u << ", idx = " << idx);
+        CHECK(sampling::sample_once(psi, positions, u) == sampling::extract_bits(idx, positions));
+    }
+}
+
+TEST_CASE("Sampler/Distribution of the shots", "[sampling][simulator]") {
+    const auto method = GENERATE(Sampler::Method::binary_search, Sampler::Method::sorted_sweep);
+    const auto positions = GENERATE(std::vector<unsigned>{5, 1, 3}, std::vector<unsigned>{0, 1, 2, 3, 4, 5});
+    INFO("method = " << static_cast<int>(method) << ", num_measured = " << positions.size());
+
+    constexpr auto shots = 200000U;
+    const auto psi = ts::random_state(6, 3);
+    const auto probs = marginal(psi, positions);
+
+    std::mt19937 rng(42);
+    const auto outcomes = Sampler(psi, positions).sample(shots, rng, method);
+    REQUIRE(outcomes.size() == shots);
+
+    std::vector<double> counts(probs.size(), 0.);
+    for (auto outcome : outcomes) {
+        REQUIRE(outcome < counts.size());
+        counts[outcome] += 1.;
+    }
+    for (std::size_t b = 0; b < probs.size(); ++b) {
+        INFO("b = " << b);
+        const auto sigma = std::sqrt(shots * probs[b] * (1. - probs[b]));
+        CHECK(std::abs(counts[b] - shots * probs[b]) <= 5. * sigma + 1.);
+    }
+
+    // Consecutive shots are independent (i.e. not sorted)
+    CHECK_FALSE(std::is_sorted(begin(outcomes), end(outcomes)));
+}
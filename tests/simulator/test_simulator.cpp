@@ -0,0 +1,299 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <complex>
+#include <cstddef>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+// clang-format off
+#include "simulator/cintrin.hpp"
+#include "simulator/dispatch.hpp"
+#include "simulator/types.hpp"
+#if defined(INTRIN) && !defined(NOINTRIN)
+#    include "simulator/_cppkernels/vector/kernel1.hpp"
+#    include "simulator/_cppkernels/vector/kernel2.hpp"
+#    include "simulator/_cppkernels/vector/kernel3.hpp"
+#    include "simulator/_cppkernels/vector/kernel4.hpp"
+#    include "simulator/_cppkernels/vector/kernel5.hpp"
+#else
+#    include "simulator/_cppkernels/scalar/kernel1.hpp"
+#    include "simulator/_cppkernels/scalar/kernel2.hpp"
+#    include "simulator/_cppkernels/scalar/kernel3.hpp"
+#    include "simulator/_cppkernels/scalar/kernel4.hpp"
+#    include "simulator/_cppkernels/scalar/kernel5.hpp"
+#endif  // INTRIN && !NOINTRIN
+// clang-format on
+
+#include "simulator/simulator.hpp"
+#include "simulator/structured_kernels.hpp"
+#include "simulator/utils.hpp"
+
+// =============================================================================
+
+namespace ts = tests::simulator;
+
+using types::M;
+using types::UINT;
+
+namespace {
+template <class state_t, int CTRLMASK>
+void dispatch(state_t& psi, const M& m, UINT ctrlmask, const unsigned* ids, unsigned nids) {
+    switch (nids) {
+        case 1:
+            details::kernel1::dispatch<state_t, M, UINT, CTRLMASK>(psi, m, ctrlmask, ids);
+            break;
+        case 2:
+            details::kernel2::dispatch<state_t, M, UINT, CTRLMASK>(psi, m, ctrlmask, ids);
+            break;
+        case 3:
+            details::kernel3::dispatch<state_t, M, UINT, CTRLMASK>(psi, m, ctrlmask, ids);
+            break;
+        case 4:
+            details::kernel4::dispatch<state_t, M, UINT, CTRLMASK>(psi, m, ctrlmask, ids);
+            break;
+        case 5:
+            details::kernel5::dispatch<state_t, M, UINT, CTRLMASK>(psi, m, ctrlmask, ids);
+            break;
+        default:
+            FAIL("Unsupported number of qubits");
+    }
+}
+
+template <class state_t>
+void dense(state_t& psi, const M& m, UINT ctrlmask, const fusion::Fusion::IndexVector& ids, unsigned nids) {
+    if (ctrlmask == 0) {
+        dispatch<state_t, 0>(psi, m, ctrlmask, ids.data(), nids);
+    } else {
+        dispatch<state_t, 1>(psi, m, ctrlmask, ids.data(), nids);
+    }
+}
+
+template <class state_t>
+void structured(state_t& psi, const fusion::StructuredGate& gate, UINT ctrlmask,
+                const fusion::Fusion::IndexVector& ids, unsigned nids) {
+    details::kernel_structured(psi, gate, ctrlmask, ids.data(), nids);
+}
+
+template <typename simulator_t = Simulator>
+simulator_t make_simulator() {
+    using state_t = typename simulator_t::StateVector;
+    return simulator_t(1, &dense<state_t>, &structured<state_t>);
+}
+
+template <typename simulator_t>
+void allocate(simulator_t& sim, unsigned num_qubits) {
+    std::vector<unsigned> ids(num_qubits);
+    for (auto i = 0U; i < num_qubits; ++i) {
+        ids[i] = i;
+    }
+    sim.allocate_qubits(ids);
+}
+
+struct Gate {
+    M matrix;
+    ts::index_vector_t ids;
+    ts::index_vector_t ctrls;
+};
+
+std::vector<Gate> random_circuit(unsigned num_qubits, std::size_t num_gates, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<Gate> gates;
+    for (std::size_t i = 0; i < num_gates; ++i) {
+        const auto target = static_cast<unsigned>(rng() % num_qubits);
+        ts::index_vector_t ctrls;
+        if (rng() % 3 == 0) {
+            ctrls.push_back(static_cast<unsigned>((target + 1 + rng() % (num_qubits - 1)) % num_qubits));
+        }
+        gates.push_back({ts::random_matrix(1, rng), {target}, ctrls});
+    }
+    return gates;
+}
+}  // namespace
+
+// =============================================================================
+
+TEST_CASE("Simulator/Deferred flush", "[simulator]") {
+    constexpr auto num_qubits = 6U;
+    constexpr auto num_gates = 40U;
+    const auto seed = GENERATE(range(0U, 4U));
+    INFO("seed = " << seed);
+
+    const auto circuit = random_circuit(num_qubits, num_gates, seed);
+
+    // Immediate flush: one kernel launch per gate
+    auto immediate = make_simulator();
+    allocate(immediate, num_qubits);
+    for (const auto& gate : circuit) {
+        immediate.apply_controlled_gate(gate.matrix, gate.ids, gate.ctrls);
+        immediate.run();
+    }
+    auto [map_immediate, state_immediate] = immediate.cheat();
+    const ts::state_t result_immediate(begin(state_immediate), end(state_immediate));
+    CHECK(immediate.get_kernel_launches() == num_gates);
+
+    // Deferred flush: the gates are fused before being applied
+    auto deferred = make_simulator();
+    allocate(deferred, num_qubits);
+    for (const auto& gate : circuit) {
+        deferred.apply_controlled_gate(gate.matrix, gate.ids, gate.ctrls);
+    }
+    auto [map_deferred, state_deferred] = deferred.cheat();
+    const ts::state_t result_deferred(begin(state_deferred), end(state_deferred));
+    CHECK(deferred.get_kernel_launches() < immediate.get_kernel_launches());
+
+    CHECK(map_deferred == map_immediate);
+    ts::check_states_equal(result_deferred, result_immediate);
+
+    // Reference without any fusion
+    ts::state_t expected(std::size_t(1) << num_qubits, 0.);
+    expected[0] = 1.;
+    for (const auto& gate : circuit) {
+        ts::apply_matrix(expected, gate.matrix, gate.ids, gate.ctrls);
+    }
+    ts::check_states_equal(result_deferred, expected);
+}
+
+// =============================================================================
+
+TEST_CASE("Simulator/Pinned state vector", "[simulator]") {
+    constexpr auto num_qubits = 4U;
+    std::mt19937 rng(1);
+    const ts::matrix_t x{0., 1., 1., 0.};
+    const ts::matrix_t z{1., 0., 0., -1.};
+
+    auto sim = make_simulator();
+    allocate(sim, num_qubits);
+    sim.set_layout_manager(layout::LayoutManager(1, 1, 1));  // reorder as soon as possible
+
+    {
+        auto pin = sim.pin_state();
+        CHECK(sim.is_state_pinned());
+        auto [map, state] = sim.cheat();
+        const auto* data = state.data();
+
+        // No reallocation of the state vector (NB: qubit 0 is in state |0>, hence can be deallocated)
+        CHECK_THROWS_AS(sim.allocate_qubit(num_qubits), std::runtime_error);
+        CHECK_THROWS_AS(sim.deallocate_qubit(0), std::runtime_error);
+
+        // No reordering of the qubits, even though the layout manager would move qubit 3 to the lowest position
+        for (auto gate = 0; gate < 4; ++gate) {
+            sim.apply_controlled_gate(ts::random_matrix(1, rng), {num_qubits - 1}, {});
+            sim.run();
+        }
+        CHECK(sim.get_layout_manager()->num_reorders() == 0);
+        CHECK(std::get<0>(sim.cheat()) == map);
+        CHECK(std::get<1>(sim.cheat()).data() == data);
+
+        // Qubit operators are applied in place: 0.5 X_0 Z_3
+        ts::state_t expected(begin(state), end(state));
+        ts::apply_matrix(expected, x, {0});
+        ts::apply_matrix(expected, z, {3});
+        for (auto& amplitude : expected) {
+            amplitude *= 0.5;
+        }
+        sim.apply_qubit_operator(Simulator::ComplexTermsDict{{{{0, 'X'}, {3, 'Z'}}, 0.5}}, {0, 1, 2, 3});
+        auto [new_map, new_state] = sim.cheat();
+        CHECK(new_map == map);
+        CHECK(new_state.data() == data);
+        ts::check_states_equal(ts::state_t(begin(new_state), end(new_state)), expected);
+    }
+
+    // Once the pin is released, the state vector may be reallocated and reordered again
+    CHECK_FALSE(sim.is_state_pinned());
+    for (auto gate = 0; gate < 2; ++gate) {
+        sim.apply_controlled_gate(ts::random_matrix(1, rng), {num_qubits - 1}, {});
+        sim.run();
+    }
+    CHECK(sim.get_layout_manager()->num_reorders() > 0);
+    CHECK_NOTHROW(sim.allocate_qubit(num_qubits));
+}
+
+// =============================================================================
+
+TEST_CASE("Simulator/Single precision", "[simulator]") {
+    constexpr auto num_qubits = 8U;
+    constexpr auto num_gates = 60U;
+    const auto seed = GENERATE(range(0U, 4U));
+    INFO("seed = " << seed);
+
+    const auto circuit = random_circuit(num_qubits, num_gates, seed);
+
+    auto sim = make_simulator<Simulator>();
+    auto sim_float = make_simulator<SimulatorFloat>();
+    allocate(sim, num_qubits);
+    allocate(sim_float, num_qubits);
+    for (const auto& gate : circuit) {
+        sim.apply_controlled_gate(gate.matrix, gate.ids, gate.ctrls);
+        sim_float.apply_controlled_gate(gate.matrix, gate.ids, gate.ctrls);
+    }
+    const Simulator::ComplexTermsDict op{{{{0, 'X'}, {3, 'Y'}}, 0.5}, {{{1, 'Z'}, {5, 'X'}}, 0.25}};
+    sim.apply_qubit_operator(op, {0, 1, 2, 3, 4, 5, 6, 7});
+    sim_float.apply_qubit_operator(op, {0, 1, 2, 3, 4, 5, 6, 7});
+
+    auto [map, state] = sim.cheat();
+    auto [map_float, state_float] = sim_float.cheat();
+    CHECK(map_float == map);
+    ts::check_states_equal(ts::state_t(begin(state_float), end(state_float)), ts::state_t(begin(state), end(state)),
+                           1.e-5);
+}
+
+// =============================================================================
+
+TEST_CASE("Simulator/Qubit allocation", "[simulator]") {
+    constexpr auto num_qubits = 3U;
+    std::mt19937 rng(3);
+
+    auto sim = make_simulator();
+    allocate(sim, num_qubits);
+    ts::state_t expected(std::size_t(1) << num_qubits, 0.);
+    expected[0] = 1.;
+    for (const auto& gate : random_circuit(num_qubits, 10, 3)) {
+        sim.apply_controlled_gate(gate.matrix, gate.ids, gate.ctrls);
+        ts::apply_matrix(expected, gate.matrix, gate.ids, gate.ctrls);
+    }
+    sim.run();
+
+    // The state vector is only extended when it is next accessed: the old amplitudes are kept and the new ones are 0
+    sim.allocate_qubits({3, 4});
+    sim.allocate_qubit(5);
+    CHECK(sim.has_qubit(5));
+    expected.resize(std::size_t(1) << (num_qubits + 3), 0.);
+    {
+        auto [map, state] = sim.cheat();
+        CHECK(map == Simulator::Map{{0, 0}, {1, 1}, {2, 2}, {3, 3}, {4, 4}, {5, 5}});
+        ts::check_states_equal(ts::state_t(begin(state), end(state)), expected);
+    }
+
+    const auto matrix = ts::random_matrix(1, rng);
+    sim.apply_controlled_gate(matrix, {5}, {0});
+    ts::apply_matrix(expected, matrix, {5}, {0});
+    auto [map, state] = sim.cheat();
+    ts::check_states_equal(ts::state_t(begin(state), end(state)), expected);
+
+    // A rejected allocation leaves the simulator unchanged
+    const auto* data = state.data();
+    CHECK_THROWS_AS(sim.allocate_qubits({6, 7, 6}), std::runtime_error);
+    CHECK_THROWS_AS(sim.allocate_qubits({7, 0}), std::runtime_error);
+    CHECK_FALSE(sim.has_qubit(6));
+    CHECK_FALSE(sim.has_qubit(7));
+
+    auto [new_map, new_state] = sim.cheat();
+    CHECK(new_map == map);
+    CHECK(new_state.data() == data);
+    ts::check_states_equal(ts::state_t(begin(new_state), end(new_state)), expected);
+}
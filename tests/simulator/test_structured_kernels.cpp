@@ -0,0 +1,177 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <algorithm>
+#include <complex>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "simulator/gate_kind.hpp"
+#include "simulator/structured_kernels.hpp"
+#include "simulator/types.hpp"
+#include "simulator/utils.hpp"
+
+// =============================================================================
+
+using fusion::GateKind;
+
+namespace ts = tests::simulator;
+
+namespace {
+//! Random matrix of a given kind acting on num_qubits qubits
+auto random_structured_matrix(GateKind kind, unsigned num_qubits, std::mt19937& rng) {
+    const auto dim = std::size_t(1) << num_qubits;
+    std::vector<std::size_t> perm(dim);
+    std::iota(begin(perm), end(perm), 0);
+    if (kind != GateKind::diagonal) {
+        std::shuffle(begin(perm), end(perm), rng);
+    }
+
+    std::uniform_real_distribution<double> angle(0., 2. * M_PI);
+    ts::matrix_t m(dim * dim);
+    for (std::size_t i = 0; i < dim; ++i) {
+        m[i * dim + perm[i]] = kind == GateKind::permutation ? ts::complex_t{1.} : std::polar(1., angle(rng));
+    }
+    return m;
+}
+}  // namespace
+
+// =============================================================================
+
+TEST_CASE("StructuredGate/Classify", "[structured][simulator]") {
+    const ts::complex_t I(0., 1.);
+    const auto s2 = M_SQRT1_2;
+
+    CHECK(fusion::classify({1., 0., 0., -1.}).kind == GateKind::diagonal);
+    CHECK(fusion::classify({1., 0., 0., I}).kind == GateKind::diagonal);
+    CHECK(fusion::classify({0., 1., 1., 0.}).kind == GateKind::permutation);
+    CHECK(fusion::classify({0., -I, I, 0.}).kind == GateKind::phased_permutation);
+    CHECK(fusion::classify({s2, s2, s2, -s2}).kind == GateKind::general);
+    CHECK(fusion::classify({1., 0., 0., 0.}).kind == GateKind::general);  // singular
+    CHECK(fusion::classify({0., 1., 0., 1.}).kind == GateKind::general);  // singular
+
+    // SWAP
+    const auto swap = fusion::classify({1., 0., 0., 0., 0., 0., 1., 0., 0., 1., 0., 0., 0., 0., 0., 1.});
+    REQUIRE(swap.kind == GateKind::permutation);
+    CHECK(swap.dim == 4);
+    CHECK(swap.perm[0] == 0);
+    CHECK(swap.perm[1] == 2);
+    CHECK(swap.perm[2] == 1);
+    CHECK(swap.perm[3] == 3);
+
+    std::mt19937 rng(1);
+    for (auto kind : {GateKind::diagonal, GateKind::permutation, GateKind::phased_permutation}) {
+        for (unsigned n = 1; n <= 5; ++n) {
+            auto gate = fusion::classify(random_structured_matrix(kind, n, rng));
+            CHECK(gate.dim == (1U << n));
+            // NB: a random permutation might turn out to be the identity
+            if (kind != GateKind::diagonal && gate.kind == GateKind::diagonal) {
+                continue;
+            }
+            CHECK(gate.kind == kind);
+        }
+    }
+}
+
+TEST_CASE("StructuredGate/Kernels", "[structured][simulator]") {
+    constexpr auto num_qubits = 7U;
+    const auto kind = GENERATE(GateKind::diagonal, GateKind::permutation, GateKind::phased_permutation);
+    const auto num_targets = GENERATE(1U, 2U, 3U, 5U);
+    const auto seed = GENERATE(range(0U, 6U));
+    INFO("kind = " << static_cast<int>(kind) << ", num_targets = " << num_targets << ", seed = " << seed);
+
+    std::mt19937 rng(seed);
+    std::vector<unsigned> qubits(num_qubits);
+    std::iota(begin(qubits), end(qubits), 0U);
+    std::shuffle(begin(qubits), end(qubits), rng);
+
+    // Make sure qubit 0 is used as target, control or left alone
+    const ts::index_vector_t ids(begin(qubits), begin(qubits) + num_targets);
+    ts::index_vector_t ctrls;
+    if (seed % 2 == 1) {
+        ctrls.push_back(qubits[num_targets]);
+    }
+    std::size_t ctrlmask = 0;
+    for (auto ctrl : ctrls) {
+        ctrlmask |= std::size_t(1) << ctrl;
+    }
+
+    const auto m = random_structured_matrix(kind, num_targets, rng);
+    const auto gate = fusion::classify(m);
+    REQUIRE(gate.kind != GateKind::general);
+
+    auto expected = ts::random_state(num_qubits, seed);
+    auto psi = expected;
+    ts::apply_matrix(expected, m, ids, ctrls);
+    details::kernel_structured(psi, gate, ctrlmask, ids.data(), static_cast<unsigned>(ids.size()));
+
+    ts::check_states_equal(psi, expected);
+}
+
+TEST_CASE("StructuredGate/Kernels several controls", "[structured][simulator]") {
+    constexpr auto num_qubits = 9U;
+    const auto kind = GENERATE(GateKind::diagonal, GateKind::permutation, GateKind::phased_permutation);
+    const auto num_targets = GENERATE(1U, 2U, 3U);
+    const auto num_ctrls = GENERATE(2U, 3U, 4U);
+    const auto seed = GENERATE(range(0U, 6U));
+    INFO("kind = " << static_cast<int>(kind) << ", num_targets = " << num_targets << ", num_ctrls = " << num_ctrls
+                   << ", seed = " << seed);
+
+    std::mt19937 rng(seed);
+    std::vector<unsigned> qubits(num_qubits);
+    std::iota(begin(qubits), end(qubits), 0U);
+    std::shuffle(begin(qubits), end(qubits), rng);
+
+    // Controls interleaved with the targets (below, between and above them)
+    const ts::index_vector_t ids(begin(qubits), begin(qubits) + num_targets);
+    const ts::index_vector_t ctrls(begin(qubits) + num_targets, begin(qubits) + num_targets + num_ctrls);
+    std::size_t ctrlmask = 0;
+    for (auto ctrl : ctrls) {
+        ctrlmask |= std::size_t(1) << ctrl;
+    }
+
+    const auto m = random_structured_matrix(kind, num_targets, rng);
+    const auto gate = fusion::classify(m);
+    REQUIRE(gate.kind != GateKind::general);
+
+    auto expected = ts::random_state(num_qubits, seed);
+    auto psi = expected;
+    ts::apply_matrix(expected, m, ids, ctrls);
+    details::kernel_structured(psi, gate, ctrlmask, ids.data(), static_cast<unsigned>(ids.size()));
+
+    ts::check_states_equal(psi, expected);
+}
+
+TEST_CASE("StructuredGate/Kernels single precision", "[structured][simulator]") {
+    constexpr auto num_qubits = 6U;
+    const auto kind = GENERATE(GateKind::diagonal, GateKind::permutation, GateKind::phased_permutation);
+    const auto seed = GENERATE(range(0U, 3U));
+    INFO("kind = " << static_cast<int>(kind) << ", seed = " << seed);
+
+    std::mt19937 rng(seed);
+    const ts::index_vector_t ids{4, 1};
+    const ts::index_vector_t ctrls{2};
+    const auto m = random_structured_matrix(kind, 2, rng);
+    const auto gate = fusion::classify(m);
+
+    auto expected = ts::random_state(num_qubits, seed);
+    types::VF psi(begin(expected), end(expected));
+    ts::apply_matrix(expected, m, ids, ctrls);
+    details::kernel_structured(psi, gate, std::size_t(1) << 2U, ids.data(), static_cast<unsigned>(ids.size()));
+
+    ts::check_states_equal(ts::state_t(begin(psi), end(psi)), expected, 1.e-5);
+}
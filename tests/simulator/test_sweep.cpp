@@ -0,0 +1,154 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+// clang-format off
+#include "simulator/cintrin.hpp"
+#include "simulator/dispatch.hpp"
+#include "simulator/types.hpp"
+#if defined(INTRIN) && !defined(NOINTRIN)
+#    include "simulator/_cppkernels/vector/kernel1.hpp"
+#    include "simulator/_cppkernels/vector/kernel2.hpp"
+#    include "simulator/_cppkernels/vector/kernel3.hpp"
+#else
+#    include "simulator/_cppkernels/scalar/kernel1.hpp"
+#    include "simulator/_cppkernels/scalar/kernel2.hpp"
+#    include "simulator/_cppkernels/scalar/kernel3.hpp"
+#endif  // INTRIN && !NOINTRIN
+// clang-format on
+
+#include "simulator/structured_kernels.hpp"
+#include "simulator/sweep.hpp"
+#include "simulator/utils.hpp"
+
+// =============================================================================
+
+namespace ts = tests::simulator;
+
+using types::M;
+using types::UINT;
+using types::V;
+using view_t = details::state_view<V::value_type>;
+
+namespace {
+template <int CTRLMASK>
+void dispatch(view_t& psi, const M& m, UINT ctrlmask, const unsigned* ids, unsigned nids) {
+    switch (nids) {
+        case 1:
+            details::kernel1::dispatch<view_t, M, UINT, CTRLMASK>(psi, m, ctrlmask, ids);
+            break;
+        case 2:
+            details::kernel2::dispatch<view_t, M, UINT, CTRLMASK>(psi, m, ctrlmask, ids);
+            break;
+        case 3:
+            details::kernel3::dispatch<view_t, M, UINT, CTRLMASK>(psi, m, ctrlmask, ids);
+            break;
+        default:
+            FAIL("Unsupported number of qubits");
+    }
+}
+
+void dense(view_t& psi, const M& m, UINT ctrlmask, const ts::index_vector_t& ids, unsigned nids) {
+    if (ctrlmask == 0) {
+        dispatch<0>(psi, m, ctrlmask, ids.data(), nids);
+    } else {
+        dispatch<1>(psi, m, ctrlmask, ids.data(), nids);
+    }
+}
+
+void structured(view_t& psi, const fusion::StructuredGate& gate, UINT ctrlmask, const ts::index_vector_t& ids,
+                unsigned nids) {
+    details::kernel_structured(psi, gate, ctrlmask, ids.data(), nids);
+}
+}  // namespace
+
+// =============================================================================
+
+TEST_CASE("Sweep/Tiled application of gates", "[sweep][simulator]") {
+    constexpr auto num_qubits = 10U;
+    constexpr auto tile_qubits = 6U;
+    const auto seed = GENERATE(range(0U, 8U));
+    INFO("seed = " << seed);
+
+    std::mt19937 rng(seed);
+    std::vector<unsigned> low(tile_qubits);
+    std::iota(begin(low), end(low), 0U);
+
+    // Targets within the tile, controls anywhere (including above the tile)
+    std::vector<fusion::FusedGate> gates;
+    auto expected = ts::random_state(num_qubits, seed);
+    for (auto i = 0U; i < 12U; ++i) {
+        std::shuffle(begin(low), end(low), rng);
+        const auto nids = 1U + rng() % 3U;
+        ts::index_vector_t ids(begin(low), begin(low) + nids);
+        ts::index_vector_t ctrls;
+        if (rng() % 2 == 0) {
+            ctrls.push_back(tile_qubits + rng() % (num_qubits - tile_qubits));
+        }
+        if (rng() % 3 == 0) {
+            ctrls.push_back(low[nids]);
+        }
+
+        fusion::FusedGate gate;
+        gate.matrix = ts::random_matrix(nids, rng);
+        if (i % 4 == 0) {
+            // Diagonal gate
+            const auto dim = std::size_t(1) << nids;
+            for (std::size_t k = 0; k < dim * dim; ++k) {
+                if (k % (dim + 1) != 0) {
+                    gate.matrix[k] = 0.;
+                }
+            }
+        }
+        ts::apply_matrix(expected, gate.matrix, ids, ctrls);
+
+        gate.ids = ids;
+        gate.nids = nids;
+        for (auto ctrl : ctrls) {
+            gate.ctrlmask |= std::size_t(1) << ctrl;
+        }
+        gate.structure = fusion::classify(gate.matrix);
+        CHECK(gate.span() <= tile_qubits);
+        gates.push_back(gate);
+    }
+
+    auto psi_ref = ts::random_state(num_qubits, seed);
+    V psi(begin(psi_ref), end(psi_ref));
+    details::sweep(psi, gates.data(), gates.size(), tile_qubits, dense, structured);
+
+    ts::check_states_equal(ts::state_t(begin(psi), end(psi)), expected);
+}
+
+TEST_CASE("Sweep/Tile larger than the state", "[sweep][simulator]") {
+    std::mt19937 rng(3);
+    fusion::FusedGate gate;
+    gate.matrix = ts::random_matrix(2, rng);
+    gate.ids = {0, 2};
+    gate.nids = 2;
+    gate.ctrlmask = 1U << 1U;
+
+    auto expected = ts::random_state(3);
+    V psi(begin(expected), end(expected));
+    ts::apply_matrix(expected, gate.matrix, gate.ids, {1});
+    details::sweep(psi, &gate, 1, 10, dense, structured);
+
+    ts::check_states_equal(ts::state_t(begin(psi), end(psi)), expected);
+}
@@ -0,0 +1,215 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "simulator/pauli_sum.hpp"
+#include "simulator/time_evolution.hpp"
+#include "simulator/utils.hpp"
+
+// =============================================================================
+
+namespace ts = tests::simulator;
+
+using term_t = std::vector<std::pair<unsigned, char>>;
+using hamiltonian_t = std::vector<std::pair<term_t, double>>;
+
+namespace {
+//! Reference H|psi>, applying the Pauli operators of each term one after the other
+ts::state_t apply_hamiltonian(const ts::state_t& psi, const hamiltonian_t& ham, std::size_t ctrlmask = 0) {
+    const ts::complex_t I(0., 1.);
+    ts::state_t res(psi.size(), 0.);
+    for (const auto& [term, coeff] : ham) {
+        auto phi = psi;
+        for (const auto& [qubit, op] : term) {
+            ts::matrix_t m;
+            if (op == 'X') {
+                m = {0., 1., 1., 0.};
+            } else if (op == 'Y') {
+                m = {0., -I, I, 0.};
+            } else {
+                m = {1., 0., 0., -1.};
+            }
+            ts::apply_matrix(phi, m, {qubit});
+        }
+        for (std::size_t i = 0; i < psi.size(); ++i) {
+            res[i] += coeff * phi[i];
+        }
+    }
+    for (std::size_t i = 0; i < psi.size(); ++i) {
+        if ((i & ctrlmask) != ctrlmask) {
+            res[i] = 0.;
+        }
+    }
+    return res;
+}
+
+//! Reference exp(-i H t)|psi> using many small Taylor steps
+ts::state_t reference_evolution(ts::state_t psi, const hamiltonian_t& ham, double time, std::size_t ctrlmask = 0) {
+    constexpr auto num_steps = 200;
+    const auto dt = time / num_steps;
+    for (auto step = 0; step < num_steps; ++step) {
+        auto term = psi;
+        for (auto k = 1; k < 30; ++k) {
+            term = apply_hamiltonian(term, ham, ctrlmask);
+            for (auto& amp : term) {
+                amp *= ts::complex_t(0., -dt) / static_cast<double>(k);
+            }
+            for (std::size_t i = 0; i < psi.size(); ++i) {
+                psi[i] += term[i];
+            }
+        }
+    }
+    return psi;
+}
+
+hamiltonian_t random_hamiltonian(unsigned num_qubits, std::size_t num_terms, std::mt19937& rng) {
+    std::uniform_int_distribution<unsigned> qubit(0, num_qubits - 1);
+    std::uniform_int_distribution<unsigned> length(1, 4);
+    std::uniform_int_distribution<int> op(0, 2);
+    std::uniform_real_distribution<double> coeff(-1., 1.);
+
+    hamiltonian_t ham{{{}, coeff(rng)}};
+    for (std::size_t t = 0; t < num_terms; ++t) {
+        std::vector<bool> used(num_qubits, false);
+        term_t term;
+        for (auto k = length(rng); k > 0; --k) {
+            const auto q = qubit(rng);
+            if (!used[q]) {
+                used[q] = true;
+                term.emplace_back(q, static_cast<char>('X' + op(rng)));
+            }
+        }
+        ham.emplace_back(term, coeff(rng));
+    }
+    return ham;
+}
+
+pauli::CompiledPauliSum compile(const hamiltonian_t& ham) {
+    return pauli::CompiledPauliSum(ham, [](unsigned q) { return q; });
+}
+}  // namespace
+
+// =============================================================================
+
+TEST_CASE("TimeEvolution/Compiled Pauli sum", "[evolution][simulator]") {
+    constexpr auto num_qubits = 6U;
+    const std::size_t ctrlmask = GENERATE(0U, 0b100U);
+    std::mt19937 rng(1);
+    const auto ham = random_hamiltonian(num_qubits, 20, rng);
+    const auto op = compile(ham);
+    CHECK(op.size() == ham.size());
+    CHECK(op.num_groups() <= op.size());
+
+    const auto psi = ts::random_state(num_qubits);
+    ts::state_t res;
+    op.apply(psi, res, ctrlmask);
+    const auto expected = apply_hamiltonian(psi, ham, ctrlmask);
+    ts::check_states_equal(res, expected);
+
+    // <psi|H|psi> without storing H|psi>
+    if (ctrlmask == 0) {
+        ts::complex_t value = 0.;
+        for (std::size_t i = 0; i < psi.size(); ++i) {
+            value += std::conj(psi[i]) * expected[i];
+        }
+        CHECK(op.expectation(psi) == Approx(value.real()));
+    }
+
+    // Remapping the qubits
+    const auto reversed = op.remapped([](unsigned q) { return num_qubits - 1 - q; });
+    hamiltonian_t ham_reversed = ham;
+    for (auto& [term, coeff] : ham_reversed) {
+        for (auto& local_op : term) {
+            local_op.first = num_qubits - 1 - local_op.first;
+        }
+    }
+    reversed.apply(psi, res, ctrlmask);
+    ts::check_states_equal(res, apply_hamiltonian(psi, ham_reversed, ctrlmask));
+}
+
+TEST_CASE("TimeEvolution/Special functions", "[evolution][simulator]") {
+    const auto j = evolution::details::bessel_j(2.5, 3);
+    CHECK(j[0] == Approx(-0.0483837764681979));
+    CHECK(j[1] == Approx(0.4970941024642741));
+    CHECK(j[2] == Approx(0.4460590733976356));
+    CHECK(j[3] == Approx(0.2166003910391135));
+    CHECK(evolution::details::bessel_j(40., 40)[40] == Approx(0.1307805452851668));
+
+    // Tridiagonal matrix with diagonal 2 and off-diagonal -1: eigenvalues 2 - 2 cos(k pi / (n + 1))
+    std::vector<double> d(5, 2.);
+    std::vector<double> z;
+    evolution::details::tridiagonal_eigen(d, std::vector<double>(5, -1.), z);
+    std::sort(begin(d), end(d));
+    for (std::size_t k = 0; k < d.size(); ++k) {
+        CHECK(d[k] == Approx(2. - 2. * std::cos((k + 1.) * M_PI / 6.)));
+    }
+}
+
+TEST_CASE("TimeEvolution/Propagators", "[evolution][simulator]") {
+    constexpr auto num_qubits = 5U;
+    const auto method = GENERATE(evolution::Method::lanczos, evolution::Method::chebyshev);
+    const auto time = GENERATE(0.3, 2.5, -1.7);
+    const std::size_t ctrlmask = GENERATE(0U, 0b10000U);
+    INFO("method = " << static_cast<int>(method) << ", time = " << time << ", ctrlmask = " << ctrlmask);
+
+    std::mt19937 rng(2);
+    const auto ham = random_hamiltonian(num_qubits - 1, 12, rng);
+    const auto op = compile(ham);
+    const auto radius = op.radius();
+    auto apply_h = [&op, ctrlmask](const ts::state_t& src, ts::state_t& dst) { op.apply(src, dst, ctrlmask); };
+
+    evolution::Options options;
+    options.method = method;
+    options.krylov_dim = 8;                    // force several Lanczos steps
+    options.max_buffers = GENERATE(4U, 9U);  // regenerated or stored Krylov basis
+    INFO("max_buffers = " << options.max_buffers);
+    memory::WorkspacePool<ts::state_t> pool;
+    evolution::Workspace<ts::state_t> workspace(pool);
+
+    const auto psi0 = ts::random_state(num_qubits);
+    auto psi = psi0;
+    evolution::evolve(psi, apply_h, time, radius, workspace, options);
+    const auto expected = reference_evolution(psi0, ham, time, ctrlmask);
+    ts::check_states_equal(psi, expected, 1.e-8);
+
+    // Reuse of the workspace
+    psi = psi0;
+    evolution::evolve(psi, apply_h, time, radius, workspace, options);
+    ts::check_states_equal(psi, expected, 1.e-8);
+
+    // Buffers leased per call: at most pool.num_free() buffers are kept once the workspace is gone
+    psi = psi0;
+    {
+        evolution::Workspace<ts::state_t> other(pool);
+        evolution::evolve(psi, apply_h, time, radius, other, options);
+    }
+    ts::check_states_equal(psi, expected, 1.e-8);
+    CHECK(pool.num_free() <= memory::WorkspacePool<ts::state_t>::default_max_free);
+
+    // The Lanczos propagator needs at least 4 buffers
+    if (method == evolution::Method::lanczos) {
+        options.max_buffers = 3;
+        psi = psi0;
+        CHECK_THROWS_AS(evolution::evolve(psi, apply_h, time, radius, workspace, options), std::invalid_argument);
+    }
+}
@@ -0,0 +1,110 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include <complex>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "simulator/types.hpp"
+#include "simulator/workspace_pool.hpp"
+
+// =============================================================================
+
+using memory::WorkspacePool;
+using types::StateVector;
+
+TEST_CASE("WorkspacePool/Reuse of buffers", "[workspace][simulator]") {
+    WorkspacePool<StateVector> pool;
+    const std::complex<double>* data = nullptr;
+    {
+        auto buffer = pool.acquire(1024);
+        CHECK(buffer->size() == 1024);
+        data = buffer->data();
+        CHECK(pool.num_free() == 0);
+    }
+    CHECK(pool.num_free() == 1);
+
+    // A smaller buffer reuses the same memory
+    {
+        auto buffer = pool.acquire(512);
+        CHECK(buffer->size() == 512);
+        CHECK(buffer->data() == data);
+        CHECK(pool.num_free() == 0);
+    }
+
+    // A larger buffer requires a new allocation
+    {
+        auto buffer = pool.acquire(4096);
+        CHECK(buffer->capacity() >= 4096);
+        CHECK(pool.num_free() == 1);
+    }
+    CHECK(pool.num_free() == 2);
+
+    pool.clear();
+    CHECK(pool.num_free() == 0);
+}
+
+TEST_CASE("WorkspacePool/Swap with the state vector", "[workspace][simulator]") {
+    WorkspacePool<StateVector> pool(1);
+    StateVector state(16, 1.);
+    const auto* old_data = state.data();
+    {
+        auto buffer = pool.acquire(32);
+        for (auto& amp : *buffer) {
+            amp = 2.;
+        }
+        std::swap(state, *buffer);
+    }
+    CHECK(state.size() == 32);
+    CHECK(state[31] == std::complex<double>(2.));
+
+    // The memory of the old state vector was recycled
+    REQUIRE(pool.num_free() == 1);
+    auto buffer = pool.acquire(16);
+    CHECK(buffer->data() == old_data);
+
+    // Only the largest buffers are kept
+    pool.recycle(StateVector(8));
+    pool.recycle(StateVector(64));
+    CHECK(pool.num_free() == 1);
+    CHECK(pool.acquire(64)->capacity() >= 64);
+}
+
+TEST_CASE("WorkspacePool/Independent pools on separate threads", "[workspace][simulator]") {
+    constexpr auto num_threads = 4;
+    std::vector<std::thread> threads;
+    std::vector<int> ok(num_threads, 0);
+    for (auto t = 0; t < num_threads; ++t) {
+        threads.emplace_back([t, &ok] {
+            WorkspacePool<StateVector> pool;
+            StateVector state(1UL << 10U, static_cast<double>(t));
+            for (auto iter = 0; iter < 100; ++iter) {
+                auto buffer = pool.acquire(state.size());
+                for (std::size_t i = 0; i < state.size(); ++i) {
+                    (*buffer)[i] = state[i] + 1.;
+                }
+                std::swap(state, *buffer);
+            }
+            ok[t] = static_cast<int>(state.front() == std::complex<double>(t + 100.) && pool.num_free() == 1);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (auto t = 0; t < num_threads; ++t) {
+        CHECK(ok[t] == 1);
+    }
+}
@@ -0,0 +1,122 @@
+//   Copyright 2022 <Huawei Technologies Co., Ltd>
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#ifndef TESTS_SIMULATOR_UTILS_HPP
+#define TESTS_SIMULATOR_UTILS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "simulator/fusion.hpp"
+
+namespace tests::simulator {
+using complex_t = std::complex<double>;
+using state_t = std::vector<complex_t>;
+using matrix_t = fusion::Fusion::Matrix;
+using index_vector_t = fusion::Fusion::IndexVector;
+
+//! Naive (reference) application of a matrix on a state vector
+/*!
+ * Bit \c l of the local index of the matrix corresponds to qubit \c ids[l]. All the \c ctrls qubits need to be in
+ * state |1> for the matrix to be applied.
+ */
+inline void apply_matrix(state_t& psi, const matrix_t& m, const index_vector_t& ids, const index_vector_t& ctrls = {}) {
+    const auto dim = std::size_t(1) << ids.size();
+    std::size_t mask = 0;
+    for (auto id : ids) {
+        mask |= std::size_t(1) << id;
+    }
+    std::size_t ctrlmask = 0;
+    for (auto ctrl : ctrls) {
+        ctrlmask |= std::size_t(1) << ctrl;
+    }
+
+    state_t v(dim);
+    std::vector<std::size_t> idx(dim);
+    for (std::size_t i = 0; i < psi.size(); ++i) {
+        if ((i & mask) != 0 || (i & ctrlmask) != ctrlmask) {
+            continue;
+        }
+        for (std::size_t k = 0; k < dim; ++k) {
+            idx[k] = i;
+            for (std::size_t l = 0; l < ids.size(); ++l) {
+                idx[k] |= ((k >> l) & 1U) << ids[l];
+            }
+            v[k] = psi[idx[k]];
+        }
+        for (std::size_t k = 0; k < dim; ++k) {
+            complex_t res = 0.;
+            for (std::size_t j = 0; j < dim; ++j) {
+                res += m[k * dim + j] * v[j];
+            }
+            psi[idx[k]] = res;
+        }
+    }
+}
+
+//! Apply a (fused) gate block on a state vector
+inline void apply_fusion(state_t& psi, fusion::Fusion& block) {
+    matrix_t m;
+    index_vector_t ids;
+    index_vector_t ctrls;
+    block.perform_fusion(m, ids, ctrls);
+    apply_matrix(psi, m, ids, ctrls);
+}
+
+//! Generate a random normalised state vector
+inline state_t random_state(unsigned num_qubits, unsigned seed = 42) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> dist;
+    state_t psi(std::size_t(1) << num_qubits);
+    double norm = 0.;
+    for (auto& amp : psi) {
+        amp = {dist(rng), dist(rng)};
+        norm += std::norm(amp);
+    }
+    for (auto& amp : psi) {
+        amp /= std::sqrt(norm);
+    }
+    return psi;
+}
+
+//! Generate a random (not necessarily unitary) dense matrix acting on num_qubits qubits
+/*!
+ * The entries are scaled so that the norm of a state vector is roughly preserved on average.
+ */
+inline matrix_t random_matrix(unsigned num_qubits, std::mt19937& rng) {
+    const auto dim = std::size_t(1) << num_qubits;
+    std::normal_distribution<double> dist(0., 1. / std::sqrt(2. * static_cast<double>(dim)));
+    matrix_t m(dim * dim);
+    for (auto& el : m) {
+        el = {dist(rng), dist(rng)};
+    }
+    return m;
+}
+
+inline void check_states_equal(const state_t& lhs, const state_t& rhs, double tol = 1.e-10) {
+    REQUIRE(std::size(lhs) == std::size(rhs));
+    for (std::size_t i = 0; i < std::size(lhs); ++i) {
+        INFO("i = " << i);
+        CHECK(std::abs(lhs[i] - rhs[i]) < tol * std::max(1., std::abs(lhs[i])));
+    }
+}
+}  // namespace tests::simulator
+
+#endif /* TESTS_SIMULATOR_UTILS_HPP */
@@ -13,9 +13,11 @@
 #   See the License for the specific language governing permissions and
 #   limitations under the License.
 
+import gc
 import math
 import warnings
 
+import numpy as np
 import pytest
 
 from mindquantum.experimental import ops, simulator, symengine
@@ -229,3 +231,130 @@ def test_two_qubit_param_gates(angle, mq_gate, pq_gate):
 
     assert mq_map == pq_map
     assert pytest.approx(pq_state) == pq_state
+
+
+# ==============================================================================
+
+
+def run_mindquantum_circuit(n_qubits, seed, precision):
+    qubits, circuit, _ = mindquantum_setup(seed, n_qubits)
+    mq_sim = simulator.projectq.Simulator(seed, precision)
+
+    for idx, qubit in enumerate(qubits):
+        circuit.apply_operator(ops.H(), [qubit])
+        circuit.apply_operator(ops.Rx(0.3 * (idx + 1)), [qubit])
+    circuit.apply_operator(ops.Rxx(0.7), [qubits[0], qubits[1]])
+    circuit.apply_operator(ops.Ryy(1.1), [qubits[1], qubits[2]])
+    circuit.apply_operator(ops.Rzz(0.4), [qubits[2], qubits[3]])
+    circuit.apply_operator(ops.T(), [qubits[3]])
+    circuit.apply_operator(ops.Swap(), [qubits[0], qubits[3]])
+    circuit.apply_operator(ops.SqrtSwap(), [qubits[1], qubits[2]])
+    assert mq_sim.run_circuit(circuit)
+
+    return mq_sim
+
+
+@pytest.mark.cxx_exp_projectq
+def test_single_precision():
+    precision_t = simulator.projectq.Simulator.precision_t
+    seed = 98138
+    n_qubits = 4
+
+    sim = run_mindquantum_circuit(n_qubits, seed, precision_t.fp64)
+    sim_float = run_mindquantum_circuit(n_qubits, seed, precision_t.fp32)
+    assert sim.precision == precision_t.fp64
+    assert sim_float.precision == precision_t.fp32
+
+    mq_map, mq_state = sim.cheat()
+    mq_map_float, mq_state_float = sim_float.cheat()
+    assert mq_map == mq_map_float
+    assert pytest.approx(mq_state, abs=1e-5) == mq_state_float
+
+    _, view = sim_float.get_state_view()
+    assert view.dtype == np.complex64
+    assert pytest.approx(mq_state, abs=1e-5) == list(view)
+
+
+# ==============================================================================
+
+
+def prepared_simulator(n_qubits=2):
+    qubits, circuit, mq_sim = mindquantum_setup(98138, n_qubits)
+    circuit.apply_operator(ops.H(), [qubits[0]])
+    circuit.apply_operator(ops.Rx(0.4), [qubits[1]])
+    assert mq_sim.run_circuit(circuit)
+    return (qubits, circuit, mq_sim)
+
+
+@pytest.mark.cxx_exp_projectq
+def test_state_view_zero_copy():
+    _, _, mq_sim = prepared_simulator()
+    mq_map, mq_state = mq_sim.cheat()
+
+    mapping, view = mq_sim.get_state_view()
+    assert mapping == mq_map
+    assert pytest.approx(mq_state) == list(view)
+
+    # Both views share the memory of the state vector
+    _, writeable_view = mq_sim.get_state_view(writeable=True)
+    assert np.shares_memory(view, writeable_view)
+    writeable_view[0] = 0.5j
+    assert view[0] == 0.5j
+    assert mq_sim.cheat()[1][0] == 0.5j
+
+
+@pytest.mark.cxx_exp_projectq
+def test_state_view_read_only():
+    _, _, mq_sim = prepared_simulator()
+    _, view = mq_sim.get_state_view()
+    assert not view.flags.writeable
+    with pytest.raises(ValueError):
+        view[0] = 1
+
+
+@pytest.mark.cxx_exp_projectq
+def test_state_view_blocks_allocation():
+    qubits, circuit, mq_sim = prepared_simulator()
+    _, view = mq_sim.get_state_view()
+    sub_view = view[1:]
+    del view
+    gc.collect()
+
+    qubits.append(circuit.create_qubit())
+    circuit.apply_operator(ops.H(), [qubits[2]])
+    with pytest.raises(RuntimeError):
+        mq_sim.run_circuit(circuit)
+    assert len(mq_sim.cheat()[0]) == 2
+
+    # Allocation is allowed again once the last view is garbage collected
+    del sub_view
+    gc.collect()
+    assert mq_sim.run_circuit(circuit)
+    assert len(mq_sim.cheat()[0]) == 3
+
+
+@pytest.mark.cxx_exp_projectq
+def test_set_state_from_buffer():
+    _, _, mq_sim = prepared_simulator()
+    mq_map, _ = mq_sim.cheat()
+    ordering = sorted(mq_map, key=mq_map.get)
+
+    state = np.array([0.5, 0.5j, -0.5, 0.5], dtype=np.complex128)
+    mq_sim.set_state_from_buffer(state, ordering)
+    assert pytest.approx(list(state)) == mq_sim.cheat()[1]
+
+    # The state is copied into the state vector in place, so existing views see the new amplitudes
+    _, view = mq_sim.get_state_view()
+    strided = np.zeros(8, dtype=np.complex64)
+    strided[::2] = [0, 1, 0, 0]
+    mq_sim.set_state_from_buffer(strided[::2], ordering)
+    assert pytest.approx([0, 1, 0, 0]) == list(view)
+    del view
+    gc.collect()
+
+    mq_sim.set_state_from_buffer(state, ordering)
+    with pytest.raises(RuntimeError):
+        mq_sim.set_state_from_buffer(np.ones(8, dtype=np.complex128), ordering)
+    with pytest.raises(ValueError):
+        mq_sim.set_state_from_buffer(np.ones((2, 2), dtype=np.complex128), ordering)
+    assert pytest.approx(list(state)) == mq_sim.cheat()[1]
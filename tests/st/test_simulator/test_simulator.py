@@ -15,6 +15,10 @@
 # ============================================================================
 """Test simulator."""
 
+import os
+import subprocess
+import sys
+
 import numpy as np
 import pytest
 from scipy.sparse import csr_matrix
@@ -291,6 +295,130 @@ def test_non_hermitian_grad_ops():
     assert np.allclose(f, f_exp)
 
 
+@pytest.mark.parametrize("mode", ['matrix_free', 'compressed'])
+def test_sparse_hamiltonian_modes(mode):
+    """
+    Description: test matrix free and compressed hamiltonians
+    Expectation: same expectation and gradient as the sparse hamiltonian.
+    """
+    qubit_op = QubitOperator('X0 Y1 Z2', 0.3) + QubitOperator('Y0 X1', -0.7) + QubitOperator('Z1 Z2', 1.1)
+    qubit_op += QubitOperator('X0 X1 Z2', 0.4) + QubitOperator('', 0.2)
+    circ = Circuit([G.RX('a').on(0), G.RY('b').on(1), G.X.on(2, 1), G.RZ('c').on(2), G.H.on(0)])
+    sim = Simulator('projectq', 3)
+    sparse_ops = sim.get_expectation_with_grad(Hamiltonian(qubit_op).sparse(3), circ)
+    free_ops = sim.get_expectation_with_grad(Hamiltonian(qubit_op).sparse(3, **{mode: True}), circ)
+    data = np.array([0.2, 1.3, -0.5])
+    f_sparse, g_sparse = sparse_ops(data)
+    f_free, g_free = free_ops(data)
+    assert np.allclose(f_sparse, f_free)
+    assert np.allclose(g_sparse, g_free)
+
+
+def test_sparse_hamiltonian_dense_matrix():
+    """
+    Description: test the sparse hamiltonian against the origin hamiltonian and the dense qubit operator matrix
+    Expectation: same state after applying the hamiltonian and same expectation.
+    """
+    n_qubits = 5
+    # Y terms give imaginary and real phases, terms sharing a X mask are grouped with different signs
+    qubit_op = QubitOperator('X0 Y1 Z2', 0.3) + QubitOperator('Y0 X1', -0.7) + QubitOperator('Y0 Y1 Y3', 0.9)
+    qubit_op += QubitOperator('X0 X1 Z4', 0.4) + QubitOperator('Z0 Z1', 1.1) + QubitOperator('Y2 Z3 Y4', -0.6)
+    qubit_op += QubitOperator('Y3', 0.25) + QubitOperator('', 0.2)
+    mat = qubit_op.matrix(n_qubits).toarray()
+    rng = np.random.default_rng(42)
+    qs = rng.normal(size=1 << n_qubits) + 1j * rng.normal(size=1 << n_qubits)
+    qs /= np.linalg.norm(qs)
+    for ham in (Hamiltonian(qubit_op), Hamiltonian(qubit_op).sparse(n_qubits)):
+        sim = Simulator('projectq', n_qubits)
+        sim.set_qs(qs)
+        assert np.allclose(sim.get_expectation(ham), np.vdot(qs, mat @ qs))
+        sim.apply_hamiltonian(ham)
+        assert np.allclose(sim.get_qs(), mat @ qs)
+
+
+def test_apply_hamiltonian_repeatedly():
+    """
+    Description: test applying sparse hamiltonians several times in a row on one simulator
+    Expectation: same states and expectations as the origin hamiltonian.
+    """
+    n_qubits = 4
+    qubit_op = QubitOperator('X0 Y1', 0.5) + QubitOperator('Y0 Z2 X3', -0.8) + QubitOperator('Z1 Z3', 0.3)
+    qubit_op += QubitOperator('Y2', 0.6) + QubitOperator('', -0.1)
+    circ = Circuit([G.RX(0.3).on(0), G.RY(1.1).on(1), G.X.on(2, 1), G.H.on(3), G.RZ(0.7).on(3, 0)])
+    origin_ham = Hamiltonian(qubit_op)
+    origin = Simulator('projectq', n_qubits)
+    origin.apply_circuit(circ)
+    expected = []
+    for _ in range(4):
+        expected.append((origin.get_expectation(origin_ham), origin.get_qs()))
+        origin.apply_hamiltonian(origin_ham)
+    modes = ({}, {'matrix_free': True}, {'compressed': True})
+    hams = [Hamiltonian(qubit_op).sparse(n_qubits, **mode) for mode in modes]
+    hams.append(Hamiltonian(csr_matrix(qubit_op.matrix(n_qubits))))
+    for ham in hams:
+        sim = Simulator('projectq', n_qubits)
+        sim.apply_circuit(circ)
+        for exp_ref, qs_ref in expected:
+            assert np.allclose(sim.get_expectation(ham), exp_ref)
+            assert np.allclose(sim.get_qs(), qs_ref)
+            sim.apply_hamiltonian(ham)
+
+
+def test_non_hermitian_expectation():
+    """
+    Description: test the expectation of a non hermitian hamiltonian
+    Expectation: same value as the inner product of H|psi> with |psi>.
+    """
+    n_qubits = 3
+    rng = np.random.default_rng(5)
+    mat = rng.normal(size=(8, 8)) + 1j * rng.normal(size=(8, 8))
+    mat[rng.uniform(size=(8, 8)) < 0.5] = 0
+    qs = rng.normal(size=8) + 1j * rng.normal(size=8)
+    qs /= np.linalg.norm(qs)
+    sim = Simulator('projectq', n_qubits)
+    sim.set_qs(qs)
+    ham = Hamiltonian(csr_matrix(mat))
+    assert np.allclose(sim.get_expectation(ham), np.vdot(mat @ qs, qs))
+    sim.apply_hamiltonian(ham)
+    sim.apply_hamiltonian(ham)
+    assert np.allclose(sim.get_qs(), mat @ mat @ qs)
+
+
+_THREADED_HD_CSR_SCRIPT = """
+import numpy as np
+from mindquantum import Hamiltonian, QubitOperator
+from mindquantum.simulator.simulator import Simulator
+
+n_qubits = 10
+rng = np.random.default_rng(7)
+qubit_op = QubitOperator('', 0.3)
+for _ in range(40):
+    term = ' '.join(f'{"IXYZ"[p]}{q}' for q, p in enumerate(rng.integers(4, size=n_qubits)) if p)
+    qubit_op += QubitOperator(term, rng.uniform(-1, 1))
+mat = qubit_op.matrix(n_qubits)
+qs = rng.normal(size=1 << n_qubits) + 1j * rng.normal(size=1 << n_qubits)
+qs /= np.linalg.norm(qs)
+for mode in ({}, {'compressed': True}):
+    ham = Hamiltonian(qubit_op).sparse(n_qubits, **mode)
+    sim = Simulator('projectq', n_qubits)
+    sim.set_qs(qs)
+    assert np.allclose(sim.get_expectation(ham), np.vdot(qs, mat @ qs))
+    sim.apply_hamiltonian(ham)
+    assert np.allclose(sim.get_qs(), mat @ qs)
+"""
+
+
+@pytest.mark.parametrize("n_threads", [2, 3, 8])
+def test_sparse_hamiltonian_threads(n_threads):
+    """
+    Description: test the half diagonal csr product with several threads, each thread owning one block of rows
+    Expectation: same state and expectation as the dense qubit operator matrix.
+    """
+    # OpenMP reads the number of threads once per process, hence the subprocess
+    env = dict(os.environ, OMP_NUM_THREADS=str(n_threads))
+    subprocess.run([sys.executable, '-c', _THREADED_HD_CSR_SCRIPT], env=env, check=True)
+
+
 def test_inner_product():
     """
     Description: test inner product of two simulator
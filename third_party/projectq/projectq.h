@@ -17,9 +17,11 @@
 #define MINDQUANTUM_BACKENDS_PROJECTQ_PROJECTQ_H_
 
 #include <cmath>
+#include <cstdlib>
 
 #include <functional>
 #include <memory>
+#include <new>
 #include <random>
 #include <string>
 #include <thread>
@@ -52,6 +54,28 @@ class Projectq : public ::projectq::Simulator {
     unsigned len_;
     RndEngine rnd_eng_;
     std::function<double()> rng_;
+    // Output buffer of ApplyHamiltonian(), swapped with vec_ so that repeated products do not allocate. Released with
+    // free() like vec_.
+    std::unique_ptr<calc_type, void (*)(void *)> ham_buffer_{nullptr, &free};
+
+    // Return the output buffer of ApplyHamiltonian() (len_ numbers, 64-byte aligned where supported)
+    calc_type *HamiltonianBuffer() {
+        if (!ham_buffer_) {
+            void *ptr = nullptr;
+#ifdef _WIN32
+            ptr = malloc(len_ * sizeof(calc_type));  // memory from _aligned_malloc() cannot be released with free()
+#else
+            if (posix_memalign(&ptr, 64, len_ * sizeof(calc_type)) != 0) {
+                ptr = nullptr;
+            }
+#endif  // _WIN32
+            if (ptr == nullptr) {
+                throw std::bad_alloc();
+            }
+            ham_buffer_.reset(static_cast<calc_type *>(ptr));
+        }
+        return ham_buffer_.get();
+    }
 
  public:
     Projectq() : Simulator(1, 1), n_qubits_(1), rnd_eng_(1), seed(1) {
@@ -283,12 +307,22 @@ class Projectq : public ::projectq::Simulator {
         Projectq::run();
         if (ham.how_to_ == ORIGIN) {
             Projectq::apply_qubit_operator(HCast<T>(ham.ham_), Projectq::ordering_);
-        } else if (ham.how_to_ == BACKEND) {
-            Projectq::vec_ = sparse::Csr_Dot_Vec<T, double>(ham.ham_sparse_main_, ham.ham_sparse_second_,
-                                                            Projectq::vec_);
+            return;
+        }
+        auto out = HamiltonianBuffer();
+        if (ham.how_to_ == BACKEND) {
+            sparse::HdCsr_Dot_Vec<T, double>(ham.ham_sparse_main_, Projectq::vec_, out);
+        } else if (ham.how_to_ == MATRIXFREE) {
+            sparse::PauliOperator_Dot_Vec<T, double>(ham.ham_matrix_free_, Projectq::vec_, out);
+        } else if (ham.how_to_ == COMPRESSED) {
+            sparse::CompactCsr_Dot_Vec<T, double>(ham.ham_sparse_compact_, Projectq::vec_, out);
         } else {
-            Projectq::vec_ = sparse::Csr_Dot_Vec<T, double>(ham.ham_sparse_main_, Projectq::vec_);
+            sparse::Csr_Dot_Vec<T, double>(ham.ham_sparse_main_, Projectq::vec_, out);
         }
+        // The previous state becomes the output buffer of the next call
+        ham_buffer_.release();
+        ham_buffer_.reset(Projectq::vec_);
+        Projectq::vec_ = out;
     }
 
     VT<CT<T>> RightSizeGrad(calc_type *left_vec, calc_type *right_vec, const Hamiltonian<T> &ham,
@@ -335,10 +369,25 @@ class Projectq : public ::projectq::Simulator {
     }
 
     CT<T> GetExpectation(const Hamiltonian<T> &ham) {
-        Projectq<T> sim = Projectq<T>(this->seed, n_qubits_, vec_);
-        sim.ApplyHamiltonian(ham);
-        auto out = ComplexInnerProduct<T, calc_type>(sim.vec_, vec_, static_cast<Index>(len_));
-        return out;
+        if (ham.how_to_ == ORIGIN) {
+            Projectq<T> sim = Projectq<T>(this->seed, n_qubits_, vec_);
+            sim.ApplyHamiltonian(ham);
+            auto out = ComplexInnerProduct<T, calc_type>(sim.vec_, vec_, static_cast<Index>(len_));
+            return out;
+        }
+        // Sparse hamiltonians are applied and contracted in a single pass, without copying the state.
+        CT<calc_type> out;
+        if (ham.how_to_ == BACKEND) {
+            out = sparse::HdCsr_Inner_Product<T, calc_type>(ham.ham_sparse_main_, vec_, vec_);
+        } else if (ham.how_to_ == MATRIXFREE) {
+            out = sparse::PauliOperator_Inner_Product<T, calc_type>(ham.ham_matrix_free_, vec_, vec_);
+        } else if (ham.how_to_ == COMPRESSED) {
+            out = sparse::CompactCsr_Inner_Product<T, calc_type>(ham.ham_sparse_compact_, vec_, vec_);
+        } else {
+            out = sparse::Csr_Inner_Product<T, calc_type>(ham.ham_sparse_main_, vec_, vec_);
+        }
+        // NB: same convention as ComplexInnerProduct(H|psi>, |psi>) above
+        return std::conj(CT<T>(out.real(), out.imag()));
     }
 
     VT<VT<CT<T>>> HermitianMeasureWithGrad(const VT<Hamiltonian<T>> &hams, const VT<BasicGate<T>> &circ,